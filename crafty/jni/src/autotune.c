@@ -1,6 +1,7 @@
+#include <math.h>
 #include "chess.h"
 #include "data.h"
-/* last modified 08/26/15 */
+/* last modified 10/19/26 */
 /*
  *******************************************************************************
  *                                                                             *
@@ -8,21 +9,23 @@
  *   them for the current hardware and a specific time per move target.  The   *
  *   syntax of the command is                                                  *
  *                                                                             *
- *         autotune time accuracy                                              *
+ *         autotune time accuracy precision                                    *
  *                                                                             *
  *   "time" is the target time to optimize for.  Longer time limits require    *
  *   somewhat different tuning values, so this should be set to the typical    *
  *   time per move.  The default is 30 seconds per move if not specified.      *
  *                                                                             *
- *   "accuracy" is normally set to 4.  Since SMP search results and times are  *
- *   non-deterministic, running tests 1 time can be inaccurate.  This value is *
- *   used to determine how many times to run each test.  If you set it to two, *
- *   the entire test will take 1/2 as long.  Bigger numbers are better, but    *
- *   it is easy to make the test run for hours if you go too far.  A big value *
- *   will work best if allowed to run overnight.  Crafty will display a time   *
- *   estimate after determining the optimal benchmark settings.  If this time  *
- *   is excessive, a ^C will let you re-start Crafty and pick a more           *
- *   reasonable time/accuracy setting.                                         *
+ *   "accuracy" is the maximum number of times each test is run, 16 if not     *
+ *   specified.  Since SMP search results and times are non-deterministic,     *
+ *   running tests 1 time can be inaccurate.  But rather than blindly running  *
+ *   every test "accuracy" times, we treat the bench times as samples and stop *
+ *   as soon as the 95% confidence interval of the mean time-to-depth is       *
+ *   narrower than "precision" percent of the mean (default 2%), or as soon    *
+ *   as the interval shows that this setting is clearly slower than the best   *
+ *   setting found so far.  At least three runs are always done.  Crafty will  *
+ *   display a time estimate after determining the optimal benchmark settings. *
+ *   If this time is excessive, a ^C will let you re-start Crafty and pick a   *
+ *   more reasonable time/accuracy setting.                                    *
  *                                                                             *
  *   AutoTune() will tune the primary SMP controls, namely the values set by   *
  *   the commands smpgroup, smpmin, smpsd and smppsl.  It will NEVER change    *
@@ -36,6 +39,10 @@
  *   low/high limits can be changed along with the interval between samples,   *
  *   by modifying the autotune data in data.c.                                 *
  *                                                                             *
+ *   The optimal values are written to the .craftyrc file.  Any settings left  *
+ *   there by an earlier autotune run are replaced rather than accumulated,    *
+ *   and they are placed ahead of a trailing "exit" command if there is one.   *
+ *                                                                             *
  *   Note that this command is best used before you go to eat or something as  *
  *   it will run a while.  If you ramp up the accuracy setting, it will take   *
  *   multiples of accuracy times longer.  Best results are likely obtained     *
@@ -44,10 +51,10 @@
  *******************************************************************************
  */
 void AutoTune(int nargs, char *args[]) {
-  unsigned int target_time = 3000, accuracy = 4, atstart, atend;
-  unsigned int time, current, setting[64], times[64], last_time, stageii;
-  int benchd, i, v, p, best, bestv, samples;
-  FILE *craftyrc = fopen(".craftyrc", "a");
+  unsigned int target_time = 3000, accuracy = 16, atstart, atend;
+  unsigned int time, current, setting[64], last_time, stageii, runs;
+  double precision = 2.0, mean[64], ci[64], best_upper;
+  int benchd, v, best, samples;
 
 /*
  ************************************************************
@@ -63,9 +70,11 @@ void AutoTune(int nargs, char *args[]) {
   if (nargs > 1)
     target_time = atoi(args[1]) * 100;
   if (nargs > 2)
-    accuracy = atoi(args[2]);
-  Print(4095, "AutoTune()  time=%s  accuracy=%d\n",
-      DisplayHHMMSS(target_time), accuracy);
+    accuracy = Max(3, atoi(args[2]));
+  if (nargs > 3)
+    precision = atof(args[3]);
+  Print(4095, "AutoTune()  time=%s  accuracy=%d  precision=%.1f%%\n",
+      DisplayHHMMSS(target_time), accuracy, precision);
 /*
  ************************************************************
  *                                                          *
@@ -75,7 +84,9 @@ void AutoTune(int nargs, char *args[]) {
  *  than six times the autotune time limit to average the   *
  *  specified time per move.  We break out of the loop when *
  *  bench takes more than 6x this time limit and use the    *
- *  previous value which just fit inside the limit.         *
+ *  previous value which just fit inside the limit.  Each   *
+ *  extra ply costs far more than the SMP noise, so one run *
+ *  per depth is plenty here.                               *
  *                                                          *
  ************************************************************
  */
@@ -88,17 +99,14 @@ void AutoTune(int nargs, char *args[]) {
   Print(4095, "Calculating optimal benchmark setting.\n");
   Print(4095, "Target time average = %s.\n", DisplayHHMMSS(6 * target_time));
   Print(4095, "Estimated run time (stage I) is %s.\n",
-      DisplayHHMMSS(accuracy * 12 * target_time));
-  Print(4095, "Estimated run time (stage II) is %s.\n",
-      DisplayHHMMSS(accuracy * stageii * 4 * target_time));
+      DisplayHHMMSS(12 * target_time));
+  Print(4095, "Estimated run time (stage II) is at most %s.\n",
+      DisplayHHMMSS(accuracy * stageii * 6 * target_time));
   Print(4095, "\nBegin stage I (calibration)\n");
   last_time = 0;
   for (benchd = -5; benchd < 10; benchd++) {
     Print(4095, "bench %2d:", benchd);
-    time = 0;
-    for (v = 0; v < accuracy; v++)
-      time += Bench(benchd, 1);
-    time /= accuracy;
+    time = Bench(benchd, 1);
     Print(4095, " ->%s\n", DisplayHHMMSS(time));
     if (time > 6 * target_time)
       break;
@@ -109,7 +117,8 @@ void AutoTune(int nargs, char *args[]) {
   atend = ReadClock();
   Print(4095, "Actual runtime for Stage I: %s\n",
       DisplayHHMMSS(atend - atstart));
-  Print(4095, "New estimated run time (stage II) is %s.\n",
+  Print(4095, "New estimated run time (stage II) is %s - %s.\n",
+      DisplayHHMMSS(3 * stageii * last_time),
       DisplayHHMMSS(accuracy * stageii * last_time));
   Print(4095, "\nBegin stage II (SMP testing).\n");
   atstart = ReadClock();
@@ -122,49 +131,184 @@ void AutoTune(int nargs, char *args[]) {
  *                                                          *
  *  The process is fairly simple, but very time-consuming.  *
  *  We will start at the min value for a single paramenter, *
- *  and run bench "accuracy" times and compute the average  *
- *  of the times.  We then repeat for the next step in the  *
- *  parameter, and continue until we try the max value that *
- *  is allowed.  We choose the parameter value that used    *
- *  the least amount of time which optimizes this value for *
- *  minimum time-to-depth.                                  *
+ *  and run bench until AutoTuneSample() says the mean time *
+ *  is known well enough.  We then repeat for the next step *
+ *  in the parameter, and continue until we try the max     *
+ *  value that is allowed.  We choose the parameter value   *
+ *  that used the least amount of time which optimizes this *
+ *  value for minimum time-to-depth.                        *
  *                                                          *
  ************************************************************
  */
   for (v = 0; v < autotune_params; v++) {
     Print(4095, "auto-tuning %s (%d ~ %d by %d)\n", tune[v].description,
         tune[v].min, tune[v].max, tune[v].increment);
-    current = *tune[v].parameter;
     samples = 0;
+    best = 0;
     if (v == 0 && tune[v].min > smp_max_threads) {
       samples = 1;
-      times[0] = 0;
       setting[0] = smp_max_threads;
-    } else
+    } else {
+      best_upper = 0.0;
       for (current = tune[v].min; current <= tune[v].max;
           current += tune[v].increment) {
         Print(4095, "Testing %d: ", current);
         *tune[v].parameter = current;
-        time = 0;
-        for (p = 0; p < accuracy; p++)
-          time += Bench(benchd, 1);
-        time /= accuracy;
-        times[samples] = time;
+        runs =
+            AutoTuneSample(benchd, accuracy, precision, best_upper,
+            &mean[samples], &ci[samples]);
+        Print(4095, " ->%s +/- %.2f (%d runs)\n",
+            DisplayHHMMSS((unsigned) mean[samples]), ci[samples] / 100.0,
+            runs);
+        if (!samples || mean[samples] < mean[best]) {
+          best = samples;
+          best_upper = mean[samples] + ci[samples];
+        }
         setting[samples++] = current;
-        Print(4095, " ->%s\n", DisplayHHMMSS(time));
-      }
-    best = 0;
-    bestv = times[0];
-    for (i = 1; i < samples; i++)
-      if (bestv > times[i]) {
-        bestv = times[i];
-        best = i;
       }
-    fprintf(craftyrc, "%s=%d\n", tune[v].command, setting[best]);
-    Print(4095, "adding " "%s=%d" " to .craftyrc file.\n", tune[v].command,
-        setting[best]);
+    }
+    *tune[v].parameter = setting[best];
+    Print(4095, "best %s=%d\n", tune[v].command, setting[best]);
   }
   atend = ReadClock();
   Print(4095, "Runtime for StageII: %s\n", DisplayHHMMSS(atend - atstart));
-  fclose(craftyrc);
+  AutoTuneSave();
+}
+
+/* last modified 10/19/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   AutoTuneSample() runs Bench() repeatedly for the current settings and     *
+ *   returns the mean time and the half-width of its 95% confidence interval   *
+ *   (Student's t, since we rarely have more than a handful of samples).  It   *
+ *   stops after "max" runs, when the interval is narrower than "precision"    *
+ *   percent of the mean, or when even the low end of the interval is slower   *
+ *   than "best_upper", the high end of the best setting's interval, since    *
+ *   more runs could not make this setting the best one.  The return value is *
+ *   the number of runs done.                                                  *
+ *                                                                             *
+ *******************************************************************************
+ */
+unsigned int AutoTuneSample(int benchd, unsigned int max, double precision,
+    double best_upper, double *mean, double *ci) {
+  static const double t95[30] = {
+    12.71, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+    2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+    2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+  };
+  double sum = 0.0, sum2 = 0.0, time, variance;
+  unsigned int n = 0;
+
+  *mean = 0.0;
+  *ci = 0.0;
+  while (n < max) {
+    time = (double) Bench(benchd, 1);
+    n++;
+    sum += time;
+    sum2 += time * time;
+    *mean = sum / n;
+    if (n < 3)
+      continue;
+    variance = Max(0.0, (sum2 - n * *mean * *mean) / (n - 1));
+    *ci = ((n - 1 <= 30) ? t95[n - 2] : 1.96) * sqrt(variance / n);
+    if (*ci <= *mean * precision / 100.0)
+      break;
+    if (best_upper > 0.0 && *mean - *ci > best_upper)
+      break;
+  }
+  return n;
+}
+
+/* last modified 10/19/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   AutoTuneSave() writes the tuned values to the .craftyrc file.  Lines that *
+ *   set one of the tuned parameters are dropped from the old file, which is  *
+ *   otherwise copied unchanged, and the new settings are inserted just ahead  *
+ *   of a trailing "exit" command (or at the end if there is none).  The new   *
+ *   file is written under a temporary name and then renamed over the old one  *
+ *   so that an interrupted run can not leave a truncated .craftyrc file.      *
+ *                                                                             *
+ *******************************************************************************
+ */
+void AutoTuneSave(void) {
+  FILE *craftyrc, *newrc;
+  char line[512], **lines = 0, **more;
+  int i, v, n = 0, max = 0, tuned, last;
+
+  craftyrc = fopen(".craftyrc", "r");
+  if (craftyrc) {
+    while (fgets(line, sizeof(line), craftyrc)) {
+      for (tuned = 0, v = 0; v < autotune_params; v++)
+        if (!strncmp(line, tune[v].command, strlen(tune[v].command)) &&
+            line[strlen(tune[v].command)] == '=')
+          tuned = 1;
+      if (tuned)
+        continue;
+      if (n == max) {
+        max = max ? 2 * max : 256;
+        more = (char **) realloc(lines, max * sizeof(char *));
+        if (!more)
+          break;
+        lines = more;
+      }
+      if (!(lines[n] = (char *) malloc(strlen(line) + 1)))
+        break;
+      strcpy(lines[n++], line);
+    }
+/*
+ ************************************************************
+ *                                                          *
+ *  If the old file could not be read completely, leave it  *
+ *  alone rather than write back a truncated copy.          *
+ *                                                          *
+ ************************************************************
+ */
+    if (ferror(craftyrc) || !feof(craftyrc)) {
+      Print(4095, "ERROR: unable to read .craftyrc, not updated\n");
+      fclose(craftyrc);
+      for (i = 0; i < n; i++)
+        free(lines[i]);
+      free(lines);
+      return;
+    }
+    fclose(craftyrc);
+  }
+  for (last = n; last > 0; last--)
+    if (strncmp(lines[last - 1], "exit", 4) && lines[last - 1][0] != '\n')
+      break;
+  if (!(newrc = fopen(".craftyrc.new", "w"))) {
+    Print(4095, "ERROR: unable to write .craftyrc\n");
+    for (i = 0; i < n; i++)
+      free(lines[i]);
+    free(lines);
+    return;
+  }
+  for (i = 0; i < last; i++)
+    fputs(lines[i], newrc);
+  for (v = 0; v < autotune_params; v++) {
+    fprintf(newrc, "%s=%d\n", tune[v].command, *tune[v].parameter);
+    Print(4095, "adding " "%s=%d" " to .craftyrc file.\n", tune[v].command,
+        *tune[v].parameter);
+  }
+  for (i = last; i < n; i++)
+    fputs(lines[i], newrc);
+  if (ferror(newrc) | fclose(newrc)) {
+    Print(4095, "ERROR: unable to write .craftyrc, not updated\n");
+    remove(".craftyrc.new");
+    for (i = 0; i < n; i++)
+      free(lines[i]);
+    free(lines);
+    return;
+  }
+#if !defined(UNIX)
+  remove(".craftyrc");
+#endif
+  if (rename(".craftyrc.new", ".craftyrc"))
+    Print(4095, "ERROR: unable to replace .craftyrc\n");
+  for (i = 0; i < n; i++)
+    free(lines[i]);
+  free(lines);
 }
@@ -78,6 +78,7 @@
 #  define MAXPLY                                 129
 #  define MAX_TC_NODES                       3000000
 #  define MAX_BLOCKS                       64 * CPUS
+#  define MAX_LARGE_SEGMENTS                       8
 #  define BOOK_CLUSTER_SIZE                     8000
 #  define MERGE_BLOCK                           1000
 #  define SORT_BLOCK                         4000000
@@ -164,9 +165,11 @@ typedef struct {
 } PATH;
 typedef struct {
   uint64_t path_sig;
+  uint64_t path_check;
   int hash_pathl;
   int hash_path_age;
   int hash_path_moves[MAXPLY];
+  char filler[64 - (24 + 4 * MAXPLY) % 64];
 } HPATH_ENTRY;
 typedef struct {
   int phase;
@@ -206,6 +209,19 @@ typedef struct {
   unsigned char status;
   unsigned char percent_play;
 } BB_POSITION;
+typedef struct {
+  char id[64];
+  char move[16];
+  int done;
+  int correct;
+  int score;
+  int depth;
+  unsigned time;
+  uint64_t nodes;
+  int solution_depth;
+  unsigned solution_time;
+  uint64_t solution_nodes;
+} TEST_RESULT;
 struct personality_term {
   char *description;
   int type;
@@ -340,6 +356,9 @@ uint64_t Attacked(TREE *RESTRICT, int, uint64_t);
 uint64_t AttacksFrom(TREE *RESTRICT, int, int);
 uint64_t AttacksTo(TREE *RESTRICT, int);
 void AutoTune(int, char **);
+void AutoTuneSave(void);
+unsigned int AutoTuneSample(int, unsigned int, double, double, double *,
+    double *);
 int Bench(int, int);
 int Bench_PGO(int, int);
 int Book(TREE *RESTRICT, int);
@@ -430,6 +449,7 @@ void InitializePawnMasks(void);
 void InitializeReductions(void);
 void InitializeSMP(void);
 int IInitializeTb(char *);
+int IPreloadTb(char *);
 int InputMove(TREE *RESTRICT, int, int, int, int, char *);
 int InputMoveICS(TREE *RESTRICT, int, int, int, int, char *);
 uint64_t InterposeSquares(int, int, int);
@@ -440,6 +460,9 @@ int Join(int64_t);
 void Kibitz(int, int, int, int, int, uint64_t, int, int, char *);
 void History(TREE *RESTRICT, int, int, int, int, int*);
 int KingPawnSquare(int, int, int, int);
+void LargeMalloc(void **, size_t);
+char *LargePages(void *);
+void LargeRemalloc(void **, size_t);
 int LearnAdjust(int);
 void LearnBook(void);
 int LearnFunction(int, int, int, int);
@@ -461,6 +484,7 @@ void Pass(void);
 int PinnedOnKing(TREE *RESTRICT, int, int);
 int Ponder(int);
 void Print(int, char *, ...);
+uint64_t HashPathCheck(int *, int);
 int HashProbe(TREE *RESTRICT, int, int, int, int, int, int*);
 void HashStore(TREE *RESTRICT, int, int, int, int, int, int);
 void HashStorePV(TREE *RESTRICT, int, int);
@@ -496,6 +520,7 @@ int SEE(TREE *RESTRICT, int, int);
 int SEEO(TREE *RESTRICT, int, int);
 void Test(char *, FILE *, int, int);
 void TestEPD(char *, FILE *, int, int);
+void TestParallel(char *, int, char *);
 void ThreadAffinity(int);
 void *STDCALL ThreadInit(void *);
 #  if !defined(UNIX)
@@ -505,6 +530,7 @@ int ThreadSplit(TREE *RESTRICT, int, int, int, int, int);
 void ThreadStop(TREE *RESTRICT);
 void ThreadTrace(TREE * RESTRICT, int, int);
 int ThreadWait(int, TREE *RESTRICT);
+void ThreadWake(void);
 int Threat(TREE *, int, int, int, int);
 void TimeAdjust(int, int);
 int TimeCheck(TREE *RESTRICT, int);
@@ -513,6 +539,7 @@ void UnmakeMove(TREE *RESTRICT, int, int, int);
 int ValidMove(TREE *RESTRICT, int, int, int);
 int VerifyMove(TREE *RESTRICT, int, int, int);
 void ValidatePosition(TREE *RESTRICT, int, int, char *);
+void VTbCacheStats(unsigned long long *);
 void WaitForAllThreadsInitialized(void);
 #  if !defined(UNIX)
 extern void *WinMallocInterleaved(size_t, int);
@@ -18,6 +18,9 @@ char history_filename[256];
 int number_of_solutions;
 int solutions[10];
 int solution_type;
+int solution_depth;
+unsigned solution_time;
+uint64_t solution_nodes;
 char cmd_buffer[4096];
 char *args[512];
 char buffer[4096];
@@ -46,6 +49,10 @@ PAWN_HASH_ENTRY *pawn_hash_table;
 uint64_t *eval_hash_table;
 void * segments[MAX_BLOCKS + 32][2];
 int nsegments = 0;
+void *large_segments[MAX_LARGE_SEGMENTS];
+size_t large_sizes[MAX_LARGE_SEGMENTS];
+int large_pages[MAX_LARGE_SEGMENTS];
+int nlarge_segments = 0;
 PATH last_pv;
 int last_value;
 int8_t directions[64][64];
@@ -585,6 +592,9 @@ unsigned int smp_gratuitous_limit = 6;  /* max gratuitous splits / thread     */
 int smp_affinity = 0;                   /* anything >= 0 is enabled           */
 int smp_numa = 0;                       /* disables NUMA mode by default      */
                                         /* enable if you really have NUMA     */
+unsigned int smp_spin_limit = 0;        /* idle spins before blocking, 0=off  */
+volatile int smp_idle_seq = 0;          /* bumped when idle threads must look */
+volatile int smp_idle_sleepers = 0;     /* idle threads blocked on the above  */
 /*
       This is the autotune configuration section.  Each line represents one
       smp search parameter that can be tuned.  The first three values are the
@@ -70,6 +70,9 @@ extern char history_filename[256];
 extern int number_of_solutions;
 extern int solutions[10];
 extern int solution_type;
+extern int solution_depth;
+extern unsigned solution_time;
+extern uint64_t solution_nodes;
 extern int abs_draw_score;
 extern int accept_draws;
 extern int offer_draws;
@@ -177,6 +180,9 @@ extern unsigned int smp_gratuitous_depth;
 extern unsigned int smp_gratuitous_limit;
 extern int smp_affinity;
 extern int smp_numa;
+extern unsigned int smp_spin_limit;
+extern volatile int smp_idle_seq;
+extern volatile int smp_idle_sleepers;
 extern int autotune_params;
 extern struct autotune tune[16];
 extern unsigned smp_split_nodes;
@@ -246,6 +252,10 @@ extern PAWN_HASH_ENTRY *pawn_hash_table;
 extern uint64_t *eval_hash_table;
 extern void *segments[MAX_BLOCKS + 32][2];
 extern int nsegments;
+extern void *large_segments[MAX_LARGE_SEGMENTS];
+extern size_t large_sizes[MAX_LARGE_SEGMENTS];
+extern int large_pages[MAX_LARGE_SEGMENTS];
+extern int nlarge_segments;
 extern const int pcval[7];
 extern const int p_vals[7];
 extern const int MVV_LVA[7][7];
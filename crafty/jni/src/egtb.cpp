@@ -81,8 +81,6 @@ typedef int piece;
 #endif
 #include <assert.h>
 
-static	lock_t	lockLRU;
-
 // Declarations
 
 typedef unsigned    char BYTE;
@@ -5376,9 +5374,40 @@ struct CTbCache         //Hungarian: tbc
 static CTbCache *ptbcTbCache;   // Cache memory
 static ULONG    ctbcTbCache;    // Cache size (in entries)
 
-static volatile CTbCache * volatile ptbcHead;       // Head of that list
-static volatile CTbCache * volatile ptbcTail;       // Last element in that list
-static volatile CTbCache * volatile ptbcFree;       // First free cache header
+// The general LRU list is split into shards, each with its own lock, free
+// list and statistics, so threads that probe different chunks no longer
+// serialize on one global LRU lock. A chunk always maps to the same shard,
+// and cache entries never migrate between shards, so eviction is LRU within
+// a shard rather than globally - close enough with a reasonable cache size.
+
+#if !defined (TB_CACHE_SHARDS)
+#  define   TB_CACHE_SHARDS         16  /* # of independent LRU lists */
+#endif
+
+typedef struct      // Hungarian: tbs
+    {
+#if (CPUS > 1)
+    lock_t                       m_lock;        // Lock on this shard's lists and counters
+#endif
+    volatile CTbCache * volatile m_ptbcHead;    // Head of the shard LRU list
+    volatile CTbCache * volatile m_ptbcTail;    // Last element in that list
+    volatile CTbCache * volatile m_ptbcFree;    // First free cache header
+    unsigned long long           m_cHits;       // Chunk found in the cache
+    unsigned long long           m_cMisses;     // Chunk read from disk
+    unsigned long long           m_cEvictions;  // Misses that had to reuse an entry
+    unsigned long long           m_cErrors;     // I/O or decompression failures
+    char                         m_rgbPad[64];  // Keep shards on separate cache lines
+    }
+    CTbCacheShard;
+
+static CTbCacheShard rgtbsShards[TB_CACHE_SHARDS];
+static int ctbsShards;          // Shards in use (fewer for a tiny cache)
+
+#define TB_SHARD(iTb, side, chunk)\
+        (& rgtbsShards[((((unsigned) (iTb)) * 2 + (unsigned) (side)) * 0x9E3779B1u + (chunk)) % ctbsShards])
+
+static INDEX cbPreloaded;       // Bytes of tables preloaded into memory
+static int   cPreloaded;        // # of tables (sides) preloaded into memory
 
 static INLINE void VTbCloseFile
     (
@@ -5426,7 +5455,14 @@ void VTbClearCache (void)
         return;
     VTbCloseFiles();
     
-    // Initialize all lists
+    // Initialize all lists, dealing entries out to the shards' free lists
+    for (i = 0; i < (ULONG) ctbsShards; i ++)
+        {
+        rgtbsShards[i].m_ptbcHead = rgtbsShards[i].m_ptbcTail = NULL;
+        rgtbsShards[i].m_ptbcFree = NULL;
+        rgtbsShards[i].m_cHits = rgtbsShards[i].m_cMisses = 0;
+        rgtbsShards[i].m_cEvictions = rgtbsShards[i].m_cErrors = 0;
+        }
     pb = (BYTE *) & ptbcTbCache [ctbcTbCache];
     for (i = 0, ptbc = ptbcTbCache; i < ctbcTbCache; i ++, ptbc ++)
         {
@@ -5434,9 +5470,9 @@ void VTbClearCache (void)
         ptbc->m_ptbcTbPrev =
         ptbc->m_ptbcTbNext =
         ptbc->m_ptbcPrev = NULL;
-        ptbc->m_ptbcNext = (ptbc + 1);
+        ptbc->m_ptbcNext = rgtbsShards[i % ctbsShards].m_ptbcFree;
+        rgtbsShards[i % ctbsShards].m_ptbcFree = ptbc;
         }
-    ptbc[-1].m_ptbcNext = NULL;
 
     // Clear references from TBs
     for (int iTb = 1; iTb < cTb; iTb ++)
@@ -5459,9 +5495,6 @@ void VTbClearCache (void)
             }
         }
 
-    // Set globals
-    ptbcHead = ptbcTail = NULL;
-    ptbcFree = ptbcTbCache;
     }
 
 extern "C" int FTbSetCacheSize
@@ -5472,11 +5505,18 @@ extern "C" int FTbSetCacheSize
     {
     VTbCloseFiles();
     ctbcTbCache = 0;
-    ptbcHead = NULL;
+    ctbsShards = 0;
     if (cbSize < sizeof (CTbCache))
         return false;
     ptbcTbCache = (CTbCache*) pv;
     ctbcTbCache = cbSize / (sizeof (CTbCache) + TB_CB_CACHE_CHUNK+32+4);
+    // Keep at least 16 entries per shard, so a tiny cache is not split
+    // into lists too short to be useful
+    ctbsShards = (int) (ctbcTbCache / 16);
+    if (ctbsShards > TB_CACHE_SHARDS)
+        ctbsShards = TB_CACHE_SHARDS;
+    if (ctbsShards < 1)
+        ctbsShards = 1;
     VTbClearCache();
     return true;
     }
@@ -5729,6 +5769,7 @@ static int TB_FASTCALL TbtProbeTable
     )
     {
     CTbDesc *ptbd;
+    CTbCacheShard *ptbs;
     int iDirectory, iExtent, iPhysicalChunk;
     volatile CTbCache * ptbc;
     volatile CTbCache * ptbcTbFirst;
@@ -5736,6 +5777,7 @@ static int TB_FASTCALL TbtProbeTable
 
     ptbd = & rgtbdDesc[iTb];
     iDirectory = TB_DIRECTORY_ENTRY (indChunk);
+    ptbs = TB_SHARD (iTb, side, indChunk);
 
     // Head of the cache bucket LRU list
     Lock (ptbd->m_prgtbcbBuckets[side][iDirectory].m_lock);
@@ -5746,23 +5788,24 @@ static int TB_FASTCALL TbtProbeTable
         {
         if (indChunk == ptbc->m_indChunk)
             {
-            // Found - move cache entry to the head of the general LRU list
-            Lock (lockLRU);
-            if (ptbc != ptbcHead)
+            // Found - move cache entry to the head of the shard LRU list
+            Lock (ptbs->m_lock);
+            ptbs->m_cHits ++;
+            if (ptbc != ptbs->m_ptbcHead)
                 {
                 // Remove it from its current position
                 ptbc->m_ptbcPrev->m_ptbcNext = ptbc->m_ptbcNext;
                 if (NULL == ptbc->m_ptbcNext)
-                    ptbcTail = ptbc->m_ptbcPrev;
+                    ptbs->m_ptbcTail = ptbc->m_ptbcPrev;
                 else
                     ptbc->m_ptbcNext->m_ptbcPrev = ptbc->m_ptbcPrev;
                 // Insert it at the head
                 ptbc->m_ptbcPrev = NULL;
-                ptbc->m_ptbcNext = ptbcHead;
-                ptbcHead->m_ptbcPrev = ptbc;
-                ptbcHead = ptbc;
+                ptbc->m_ptbcNext = ptbs->m_ptbcHead;
+                ptbs->m_ptbcHead->m_ptbcPrev = ptbc;
+                ptbs->m_ptbcHead = ptbc;
                 }
-            Unlock (lockLRU);
+            Unlock (ptbs->m_lock);
             // Move cache entry to the head of the cache bucket LRU list
             if (ptbc != ptbcTbFirst)
                 {
@@ -5793,13 +5836,14 @@ static int TB_FASTCALL TbtProbeTable
     // Unlock cache bucket, so other threads can continue execution
     Unlock (ptbd->m_prgtbcbBuckets[side][iDirectory].m_lock);
     // First, find cache entry we can use
-    Lock (lockLRU);
+    Lock (ptbs->m_lock);
+    ptbs->m_cMisses ++;
     // Get it either from a free list, or reuse last element of the LRU list
-    if (NULL != ptbcFree)
+    if (NULL != ptbs->m_ptbcFree)
         {
-        ptbc = ptbcFree;
-        ptbcFree = ptbc->m_ptbcNext;
-        Unlock (lockLRU);
+        ptbc = ptbs->m_ptbcFree;
+        ptbs->m_ptbcFree = ptbc->m_ptbcNext;
+        Unlock (ptbs->m_lock);
         }
     else
         {
@@ -5807,28 +5851,35 @@ static int TB_FASTCALL TbtProbeTable
         int      iTailTb;
         color    colorTail;
 
-        assert (NULL != ptbcTail);
+        ptbs->m_cEvictions ++;
 #if (CPUS > 1)
         // "Optimistic" model - assuming that there is low content
         // (not hundreds of threads)
         for (;;)
             {
-            ptbc = ptbcTail;
+            // Every entry of this shard can be "orphaned" by threads that
+            // are reading chunks right now. Rare, but just fail the probe.
+            if (NULL == ptbs->m_ptbcTail)
+                {
+                Unlock (ptbs->m_lock);
+                return L_bev_broken;
+                }
+            ptbc = ptbs->m_ptbcTail;
             iTailTb = ptbc->m_iTb;
             iTailDirectory = TB_DIRECTORY_ENTRY (ptbc->m_indChunk);
             colorTail = ptbc->m_color;
             // To avoid deadlocks, have to first acquire cache buckets lock,
-            // and only then general LRU lock. So, free general LRU lock and
+            // and only then shard LRU lock. So, free shard LRU lock and
             // acquire 2 locks in a proper order.
-            Unlock (lockLRU);
+            Unlock (ptbs->m_lock);
             Lock (rgtbdDesc[iTailTb].m_prgtbcbBuckets[colorTail][iTailDirectory].m_lock);
-            Lock (lockLRU);
+            Lock (ptbs->m_lock);
             // Have structures been modified while we re-acquired locks? 
             // (to be more precise, it's Ok, if structures were modified,
             // but cache entry again become the last element of the list,
             // and TB, color, and cache bucket did not changed, so we locked
             // proper locks).
-            if (ptbc == ptbcTail && ptbc->m_iTb == iTailTb &&
+            if (ptbc == ptbs->m_ptbcTail && ptbc->m_iTb == iTailTb &&
                 ptbc->m_color == colorTail &&
                 TB_DIRECTORY_ENTRY (ptbc->m_indChunk) == iTailDirectory)
                 break;
@@ -5836,19 +5887,20 @@ static int TB_FASTCALL TbtProbeTable
             Unlock (rgtbdDesc[iTailTb].m_prgtbcbBuckets[colorTail][iTailDirectory].m_lock);
             }
 #else
-        ptbc = ptbcTail;
+        assert (NULL != ptbs->m_ptbcTail);
+        ptbc = ptbs->m_ptbcTail;
         iTailTb = ptbc->m_iTb;
         iTailDirectory = TB_DIRECTORY_ENTRY (ptbc->m_indChunk);
         colorTail = ptbc->m_color;
 #endif
 
-        // Remove cache entry from the general LRU list
-        ptbcTail = ptbc->m_ptbcPrev;
-        if (NULL == ptbcTail)
-            ptbcHead = NULL;
+        // Remove cache entry from the shard LRU list
+        ptbs->m_ptbcTail = ptbc->m_ptbcPrev;
+        if (NULL == ptbs->m_ptbcTail)
+            ptbs->m_ptbcHead = NULL;
         else
-            ptbcTail->m_ptbcNext = NULL;
-        Unlock (lockLRU);
+            ptbs->m_ptbcTail->m_ptbcNext = NULL;
+        Unlock (ptbs->m_lock);
         
         // Remove it from cache bucket list
         if (NULL != ptbc->m_ptbcTbNext)
@@ -6047,16 +6099,16 @@ static int TB_FASTCALL TbtProbeTable
 
     // Read - now acquire locks and insert cache entry in both lists
     Lock (ptbd->m_prgtbcbBuckets[side][iDirectory].m_lock);
-    Lock (lockLRU);
+    Lock (ptbs->m_lock);
 
-    // Insert cache entry into general LRU list
+    // Insert cache entry into shard LRU list
     ptbc->m_ptbcPrev = NULL;
-    ptbc->m_ptbcNext = ptbcHead;
-    if (NULL == ptbcHead)
-        ptbcTail = ptbc;
+    ptbc->m_ptbcNext = ptbs->m_ptbcHead;
+    if (NULL == ptbs->m_ptbcHead)
+        ptbs->m_ptbcTail = ptbc;
     else
-        ptbcHead->m_ptbcPrev = ptbc;
-    ptbcHead = ptbc;
+        ptbs->m_ptbcHead->m_ptbcPrev = ptbc;
+    ptbs->m_ptbcHead = ptbc;
 
     // Insert cache entry into cache bucket LRU list
     ptbc->m_ptbcTbPrev = NULL;
@@ -6071,7 +6123,7 @@ static int TB_FASTCALL TbtProbeTable
     tb = (tb_t) (ptbc->m_pbData[indInChunk]);
     // Release locks
     Unlock (ptbd->m_prgtbcbBuckets[side][iDirectory].m_lock);
-    Unlock (lockLRU);
+    Unlock (ptbs->m_lock);
     return tb;
 
     // I/O error. Here I don't want to halt the program, because that can
@@ -6079,11 +6131,12 @@ static int TB_FASTCALL TbtProbeTable
 ERROR_LABEL:
     Unlock (ptbd->m_rglockFiles[side]);
 ERROR_LABEL_2:
-    Lock (lockLRU);
+    Lock (ptbs->m_lock);
+    ptbs->m_cErrors ++;
     ptbd->m_rgpchFileName[side][iExtent] = NULL;
-    ptbc->m_ptbcNext = ptbcFree;
-    ptbcFree = ptbc;
-    Unlock (lockLRU);
+    ptbc->m_ptbcNext = ptbs->m_ptbcFree;
+    ptbs->m_ptbcFree = ptbc;
+    Unlock (ptbs->m_lock);
     return L_bev_broken;
     }
 
@@ -6200,6 +6253,138 @@ extern "C" int TB_FASTCALL L_TbtProbeTable
     return tbtScore;
     }
 
+//-----------------------------------------------------------------------------
+//
+//  Preloading. A preloaded table is decompressed once into memory and from
+//  then on is probed through m_rgpbRead[], exactly as a table read by
+//  FReadTableToMemory(), without touching the cache or any lock at all.
+
+static int FTbPreloadSide
+    (
+    int     iTb,
+    color   side
+    )
+    {
+    decode_info     *info;
+    decode_block    *block = NULL;
+    BYTE            *pb;
+    FILE            *fp;
+    int             iBlock, cbBlock, fWasError;
+
+    if (rgtbdDesc[iTb].m_fSymmetric)
+        side = x_colorWhite;
+    if (NULL != rgtbdDesc[iTb].m_rgpbRead[side])
+        return true;
+    if (!FRegistered (iTb, side) || rgtbdDesc[iTb].m_fSplit || rgtbdDesc[iTb].m_f16bit)
+        return false;
+    info = rgtbdDesc[iTb].m_rgpdiDecodeInfo[side][0];
+    if (NULL == info)
+        {
+        // Uncompressed - just read the whole file
+        if (!FReadTableToMemory (iTb, side, NULL))
+            return false;
+        cbPreloaded += rgtbdDesc[iTb].m_rgcbLength[side];
+        cPreloaded ++;
+        return true;
+        }
+
+    // Compressed - decode every block in turn, each at its own offset in the
+    // table, so the stride is the table's block size. Decoder can write a few
+    // bytes past the end of the block (same slack as in cache entries)
+    cbBlock = info->block_size;
+    if (cbBlock <= 0)
+        return false;
+    pb = (BYTE*) malloc ((size_t) cbBlock * info->n_blk + 32 + 4);
+    if (NULL == pb)
+        return false;
+    fp = fopen (rgtbdDesc[iTb].m_rgpchFileName[side][0], "rb");
+    if (NULL == fp)
+        {
+        free (pb);
+        return false;
+        }
+    fWasError = 0 != comp_alloc_block (&block, cbBlock);
+    for (iBlock = 0; !fWasError && iBlock < info->n_blk; iBlock ++)
+        {
+        fWasError = 0 != comp_init_block (block, cbBlock, pb + (size_t) iBlock * cbBlock) ||
+                    0 != comp_read_block (block, info, fp, iBlock) ||
+                    0 != comp_decode_and_check_crc (block, info, block->orig.size, TB_CRC_CHECK);
+        }
+    fclose (fp);
+    if (NULL != block)
+        {
+        free (block);
+        cbEGTBCompBytes -= sizeof (*block) + cbBlock;
+        }
+    if (fWasError)
+        {
+        printf ("*** Unable to preload %s\n", rgtbdDesc[iTb].m_rgpchFileName[side][0]);
+        free (pb);
+        return false;
+        }
+
+    // Table is complete - publish it
+    rgtbdDesc[iTb].m_rgpbRead[side] = pb;
+    cbPreloaded += (INDEX) cbBlock * (info->n_blk - 1) + info->last_block_size;
+    cPreloaded ++;
+    return true;
+    }
+
+// Preload tables into memory. pszName is either a table name ("kqkr"), or a
+// number, meaning all registered tables with at most that many pieces.
+// Returns # of table files (sides) that are now resident.
+
+extern "C" int IPreloadTb
+    (
+    char    *pszName
+    )
+    {
+    int iTb, cPieces, cLoaded = 0;
+    color sd;
+
+    cPieces = (pszName[0] >= '0' && pszName[0] <= '9') ? atoi (pszName) : 0;
+    for (iTb = 1; iTb < cTb; iTb ++)
+        {
+        if (cPieces ? (int) strlen (rgtbdDesc[iTb].m_rgchName) > cPieces :
+                      0 != strcmp (rgtbdDesc[iTb].m_rgchName, pszName))
+            continue;
+        for (sd = x_colorWhite; sd <= x_colorBlack; sd = (color) (sd + 1))
+            {
+            if (x_colorBlack == sd && rgtbdDesc[iTb].m_fSymmetric)
+                break;
+            cLoaded += FTbPreloadSide (iTb, sd);
+            }
+        }
+    return cLoaded;
+    }
+
+// Cache statistics, summed over all shards:
+//  [0] hits [1] misses [2] evictions [3] errors [4] cache entries
+//  [5] shards [6] preloaded bytes [7] preloaded table files
+
+extern "C" void VTbCacheStats
+    (
+    unsigned long long  *rgcStats
+    )
+    {
+    int i;
+
+    memset (rgcStats, 0, 8 * sizeof (unsigned long long));
+    for (i = 0; i < ctbsShards; i ++)
+        {
+        Lock (rgtbsShards[i].m_lock);
+        rgcStats[0] += rgtbsShards[i].m_cHits;
+        rgcStats[1] += rgtbsShards[i].m_cMisses;
+        rgcStats[2] += rgtbsShards[i].m_cEvictions;
+        rgcStats[3] += rgtbsShards[i].m_cErrors;
+        Unlock (rgtbsShards[i].m_lock);
+        }
+    rgcStats[4] = ctbcTbCache;
+    rgcStats[5] = ctbsShards;
+    rgcStats[6] = cbPreloaded;
+    rgcStats[7] = cPreloaded;
+    }
+
 //-----------------------------------------------------------------------------
 //
 //  Global initialization
@@ -6559,7 +6744,8 @@ extern "C" int IInitializeTb
     VTbCloseFiles ();
 #if (CPUS > 1)
     // Init all locks
-    LockInit (lockLRU);
+    for (i = 0; i < TB_CACHE_SHARDS; i ++)
+        LockInit (rgtbsShards[i].m_lock);
     LockInit (lockDecode);
     for (iTb = 1; iTb < cTb; iTb ++)
         {
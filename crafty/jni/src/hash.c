@@ -1,6 +1,6 @@
 #include "chess.h"
 #include "data.h"
-/* last modified 09/16/14 */
+/* last modified 10/19/26 */
 /*
  *******************************************************************************
  *                                                                             *
@@ -62,7 +62,8 @@ int HashProbe(TREE * RESTRICT tree, int ply, int depth, int side, int alpha,
   HASH_ENTRY *htable;
   HPATH_ENTRY *ptable;
   uint64_t word1, word2, temp_hashkey;
-  int type, draft, avoid_null = 0, val, entry, i;
+  int type, draft, avoid_null = 0, val, entry, i, pathl;
+  int moves[MAXPLY];
 
 /*
  ************************************************************
@@ -144,25 +145,32 @@ int HashProbe(TREE * RESTRICT tree, int ply, int depth, int side, int alpha,
  *  For EXACT entries, we save the path from the position   *
  *  to the terminal node that produced the backed-up score  *
  *  so that we can complete the PV if we get a hash hit on  *
- *  this entry.                                             *
+ *  this entry.  The path is copied out first and then      *
+ *  checked against path_check, so a path that was torn by  *
+ *  a simultaneous store from another thread is ignored and *
+ *  the PV simply ends at this position as it would with no *
+ *  path table entry at all.                                *
  *                                                          *
  ************************************************************
  */
       switch (type) {
         case EXACT:
-          if (val > alpha && val < beta) {
+          if (val > alpha && val < beta && hash_path) {
             SavePV(tree, ply, 1);
             ptable = hash_path + (temp_hashkey & hash_path_mask);
             for (entry = 0; entry < 16; entry++)
               if (ptable[entry].path_sig == temp_hashkey) {
-                for (i = ply;
-                    i < Min(MAXPLY - 1, ptable[entry].hash_pathl + ply); i++)
-                  tree->pv[ply - 1].path[i] =
-                      ptable[entry].hash_path_moves[i - ply];
-                if (ptable[entry].hash_pathl + ply < MAXPLY - 1)
+                pathl = Max(0, Min(MAXPLY, ptable[entry].hash_pathl));
+                for (i = 0; i < pathl; i++)
+                  moves[i] = ptable[entry].hash_path_moves[i];
+                if ((ptable[entry].path_check ^ HashPathCheck(moves,
+                            pathl)) != temp_hashkey)
+                  break;
+                for (i = ply; i < Min(MAXPLY - 1, pathl + ply); i++)
+                  tree->pv[ply - 1].path[i] = moves[i - ply];
+                if (pathl + ply < MAXPLY - 1)
                   tree->pv[ply - 1].pathh = 0;
-                tree->pv[ply - 1].pathl =
-                    Min(MAXPLY - 1, ply + ptable[entry].hash_pathl);
+                tree->pv[ply - 1].pathl = Min(MAXPLY - 1, ply + pathl);
                 ptable[entry].hash_path_age = transposition_age;
                 break;
               }
@@ -183,7 +191,7 @@ int HashProbe(TREE * RESTRICT tree, int ply, int depth, int side, int alpha,
   return HASH_MISS;
 }
 
-/* last modified 09/16/14 */
+/* last modified 10/19/26 */
 /*
  *******************************************************************************
  *                                                                             *
@@ -227,7 +235,8 @@ void HashStore(TREE * RESTRICT tree, int ply, int depth, int side, int type,
   HASH_ENTRY *htable, *replace = 0;
   HPATH_ENTRY *ptable;
   uint64_t word1, temp_hashkey;
-  int entry, draft, age, replace_draft, i, j;
+  int entry, draft, age, replace_draft, i, j, pathl;
+  int replace_age, replace_pathl;
 
 /*
  ************************************************************
@@ -323,24 +332,69 @@ void HashStore(TREE * RESTRICT tree, int ply, int depth, int side, int type,
  *  we can recover the PV and see the complete path rather  *
  *  rather than one that is incomplete.                     *
  *                                                          *
+ *  The path table uses 16-entry clusters, each entry being *
+ *  padded to a multiple of 64 bytes so that it starts on a *
+ *  cache line.  We always store the path.  If the key is   *
+ *  already in the cluster we overwrite it, otherwise we    *
+ *  replace the entry from the oldest search (age is        *
+ *  computed modulo 512 since it wraps), and on a tie the   *
+ *  one with the shortest path since it is the cheapest to  *
+ *  lose.  path_check is the key xor'ed with a checksum of  *
+ *  the moves so that HashProbe() can detect an entry that  *
+ *  two threads stored simultaneously (lockless, as above). *
+ *                                                          *
  ************************************************************
  */
-  if (type == EXACT) {
+  if (type == EXACT && hash_path) {
     ptable = hash_path + (temp_hashkey & hash_path_mask);
-    for (i = 0; i < 16; i++, ptable++) {
-      if (ptable->path_sig == temp_hashkey ||
-          ((transposition_age - ptable->hash_path_age) > 1)) {
-        for (j = ply; j < tree->pv[ply - 1].pathl; j++)
-          ptable->hash_path_moves[j - ply] = tree->pv[ply - 1].path[j];
-        ptable->hash_pathl = tree->pv[ply - 1].pathl - ply;
-        ptable->path_sig = temp_hashkey;
-        ptable->hash_path_age = transposition_age;
+    pathl = Max(0, tree->pv[ply - 1].pathl - ply);
+    for (i = 0; i < 16; i++)
+      if (ptable[i].path_sig == temp_hashkey)
         break;
+    if (i == 16) {
+      replace_age = -1;
+      replace_pathl = MAXPLY + 1;
+      for (entry = 0; entry < 16; entry++) {
+        age = (transposition_age - ptable[entry].hash_path_age) & 0x1ff;
+        if (age > replace_age || (age == replace_age &&
+                ptable[entry].hash_pathl < replace_pathl)) {
+          i = entry;
+          replace_age = age;
+          replace_pathl = ptable[entry].hash_pathl;
+        }
       }
     }
+    ptable += i;
+    for (j = ply; j < ply + pathl; j++)
+      ptable->hash_path_moves[j - ply] = tree->pv[ply - 1].path[j];
+    ptable->hash_pathl = pathl;
+    ptable->path_sig = temp_hashkey;
+    ptable->path_check =
+        temp_hashkey ^ HashPathCheck(tree->pv[ply - 1].path + ply, pathl);
+    ptable->hash_path_age = transposition_age;
   }
 }
 
+/* last modified 10/19/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   HashPathCheck() computes the checksum of a path stored in the path hash   *
+ *   table.  It covers both the length and the moves, and is xor'ed with the   *
+ *   hash signature when stored so that a path whose moves came from one store *
+ *   and whose signature came from another will not validate.                  *
+ *                                                                             *
+ *******************************************************************************
+ */
+uint64_t HashPathCheck(int *moves, int length) {
+  uint64_t check = length;
+  int i;
+
+  for (i = 0; i < length; i++)
+    check = ((check << 7) | (check >> 57)) ^ (unsigned) moves[i];
+  return check;
+}
+
 /* last modified 09/16/14 */
 /*
  *******************************************************************************
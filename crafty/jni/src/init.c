@@ -87,23 +87,23 @@ void Initialize() {
     printf("ERROR, unable to open game history file, exiting\n");
     CraftyExit(1);
   }
-  AlignedMalloc((void *) ((void *) &hash_table), 64,
+  LargeMalloc((void *) ((void *) &hash_table),
       sizeof(HASH_ENTRY) * hash_table_size);
-  AlignedMalloc((void *) ((void *) &hash_path), 64,
+  LargeMalloc((void *) ((void *) &hash_path),
       sizeof(HPATH_ENTRY) * hash_path_size);
-  AlignedMalloc((void *) ((void *) &pawn_hash_table), 64,
+  LargeMalloc((void *) ((void *) &pawn_hash_table),
       sizeof(PAWN_HASH_ENTRY) * pawn_hash_table_size);
   AlignedMalloc((void *) ((void *) &eval_hash_table), 64,
       sizeof(uint64_t) * eval_hash_table_size);
   if (!hash_table) {
     Print(2048,
-        "AlignedMalloc() failed, not enough memory (primary trans/ref table).\n");
+        "LargeMalloc() failed, not enough memory (primary trans/ref table).\n");
     hash_table_size = 0;
     hash_table = 0;
   }
   if (!pawn_hash_table) {
     Print(2048,
-        "AlignedMalloc() failed, not enough memory (pawn hash table).\n");
+        "LargeMalloc() failed, not enough memory (pawn hash table).\n");
     pawn_hash_table_size = 0;
     pawn_hash_table = 0;
   }
@@ -93,6 +93,7 @@ int Iterate(int wtm, int search_type, int root_list_done) {
   }
   thread[0].tree = block[0];
   correct_count = 0;
+  solution_depth = 0;
   burp = 15 * 100;
   transposition_age = (transposition_age + 1) & 0x1ff;
   next_time_check = nodes_between_time_checks;
@@ -451,7 +452,10 @@ int Iterate(int wtm, int search_type, int root_list_done) {
  *  If we are running a test suite, check to see if we can  *
  *  exit the search.  This happens when N successive        *
  *  iterations produce the correct solution.  N is set by   *
- *  the test command in Option().                           *
+ *  the test command in Option().  We also remember when    *
+ *  the current run of correct iterations started, which    *
+ *  the "testmt" command reports as the time, nodes and     *
+ *  depth needed to solve the position.                     *
  *                                                          *
  ************************************************************
  */
@@ -463,10 +467,16 @@ int Iterate(int wtm, int search_type, int root_list_done) {
           } else if (solutions[i] == root_moves[current_rm].move)
             correct = 0;
         }
-        if (correct)
-          correct_count++;
-        else
+        if (correct) {
+          if (!correct_count++) {
+            solution_depth = iteration;
+            solution_time = ReadClock() - start_time;
+            solution_nodes = tree->nodes_searched;
+          }
+        } else {
           correct_count = 0;
+          solution_depth = 0;
+        }
 /*
  ************************************************************
  *                                                          *
@@ -711,6 +721,7 @@ int Iterate(int wtm, int search_type, int root_list_done) {
     Print(64, "terminating SMP processes.\n");
     for (proc = 1; proc < CPUS; proc++)
       thread[proc].terminate = 1;
+    ThreadWake();
     while (smp_threads);
     smp_split = 0;
   }
@@ -33,6 +33,15 @@ __forceinline void Lock(volatile LONG * hPtr) {
 }
 void Pause() {
 }
+/*
+ *  Windows has no futex, so a blocked waiter simply gives up its time slice
+ *  and the waker has nothing to do.  The adaptive locks are plain spinlocks.
+ */
+#    define AtomicAdd(v, n)       (_InterlockedExchangeAdd((LPLONG) &(v), (n)))
+#    define FutexWait(p, v, usec) (*(p) == (v) ? Sleep(1) : (void) 0)
+#    define FutexWake(p, n)
+#    define LockAdaptive(v)       Lock(v)
+#    define UnlockAdaptive(v)     Unlock(v)
 #  else
 /*
  *******************************************************************************
@@ -71,10 +80,80 @@ static void __inline__ UnlockX86(volatile int *lock) {
       :"memory");
 }
 
+/*
+ *******************************************************************************
+ *                                                                             *
+ *  FutexWait() blocks the calling thread while *p == value, for at most usec  *
+ *  microseconds, and FutexWake() releases up to n threads blocked on p.  On   *
+ *  Linux these are the futex system calls.  Other Unix systems fall back to   *
+ *  a short sleep, which still gets an idle thread off of the CPU.             *
+ *                                                                             *
+ *******************************************************************************
+ */
+#    if defined(__linux__)
+#      include <linux/futex.h>
+#      include <sys/syscall.h>
+#      include <unistd.h>
+#      include <time.h>
+static void __inline__ FutexWait(volatile int *p, int value, int usec) {
+  struct timespec timeout;
+
+  timeout.tv_sec = usec / 1000000;
+  timeout.tv_nsec = (usec % 1000000) * 1000;
+  syscall(SYS_futex, p, FUTEX_WAIT_PRIVATE, value, &timeout, NULL, 0);
+}
+static void __inline__ FutexWake(volatile int *p, int n) {
+  syscall(SYS_futex, p, FUTEX_WAKE_PRIVATE, n, NULL, NULL, 0);
+}
+#    else
+#      include <unistd.h>
+static void __inline__ FutexWait(volatile int *p, int value, int usec) {
+  if (*p == value)
+    usleep(usec < 1000 ? usec : 1000);
+}
+#      define FutexWake(p, n)
+#    endif
+/*
+ *******************************************************************************
+ *                                                                             *
+ *  LockAdaptiveX86() is a spin-then-block lock.  The lock word is 0 (free),   *
+ *  1 (held) or 2 (held, and somebody may be blocked in the kernel).  We spin  *
+ *  "spins" times with pause before giving up and blocking, where spins == 0   *
+ *  means spin forever exactly like LockX86().  UnlockAdaptiveX86() only pays  *
+ *  for the wake system call if a waiter actually marked the lock with a 2.    *
+ *                                                                             *
+ *******************************************************************************
+ */
+static void __inline__ LockAdaptiveX86(volatile int *lock, unsigned spins) {
+  unsigned i;
+  int c;
+
+  if (!(c = __sync_val_compare_and_swap(lock, 0, 1)))
+    return;
+  for (i = 0; !spins || i < spins; i++) {
+    Pause();
+    if (!*lock && !(c = __sync_val_compare_and_swap(lock, 0, 1)))
+      return;
+  }
+  if (c != 2)
+    c = __sync_lock_test_and_set(lock, 2);
+  while (c) {
+    FutexWait(lock, 2, 10000);
+    c = __sync_lock_test_and_set(lock, 2);
+  }
+}
+static void __inline__ UnlockAdaptiveX86(volatile int *lock) {
+  if (__sync_fetch_and_and(lock, 0) == 2)
+    FutexWake(lock, 1);
+}
+
 #    define LockInit(p)           (p=0)
 #    define LockFree(p)           (p=0)
 #    define Unlock(p)             (UnlockX86(&p))
 #    define Lock(p)               (LockX86(&p))
+#    define UnlockAdaptive(p)     (UnlockAdaptiveX86(&p))
+#    define LockAdaptive(p)       (LockAdaptiveX86(&p, smp_spin_limit))
+#    define AtomicAdd(v, n)       (__sync_fetch_and_add(&(v), (n)))
 #    define lock_t                volatile int
 #  endif
 #else
@@ -82,6 +161,8 @@ static void __inline__ UnlockX86(volatile int *lock) {
 #  define LockFree(p)
 #  define Lock(p)
 #  define Unlock(p)
+#  define LockAdaptive(p)
+#  define UnlockAdaptive(p)
 #  define lock_t                volatile int
 #endif /*  SMP code */
 /* *INDENT-ON* */
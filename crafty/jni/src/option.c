@@ -592,6 +592,16 @@ int Option(TREE * RESTRICT tree) {
  *  "egtb" command enables/disables tablebases and sets     *
  *  the number of pieces available for probing.             *
  *                                                          *
+ *  "egtb stats" displays the EGTB cache counters (hits,    *
+ *  misses and evictions summed over the cache shards) and  *
+ *  how much has been preloaded.                            *
+ *                                                          *
+ *  "egtb preload <n|name> ..." decompresses tables into    *
+ *  memory once, after which they are probed directly with  *
+ *  no cache lookup or locking.  "n" loads every table with *
+ *  n or fewer pieces (egtb preload 4), otherwise the names *
+ *  given are loaded (egtb preload kqkr krkp).              *
+ *                                                          *
  ************************************************************
  */
 #if !defined(NOEGTB)
@@ -618,7 +628,30 @@ int Option(TREE * RESTRICT tree) {
     } else {
       if (nargs == 1)
         EGTBPV(tree, game_wtm);
-      else if (nargs == 2)
+      else if (OptionMatch("stats", args[1])) {
+        unsigned long long stats[8];
+
+        VTbCacheStats(stats);
+        Print(32, "EGTB cache: %s entries in %d shards\n",
+            DisplayKMB(stats[4], 0), (int) stats[5]);
+        Print(32, "  hits=%s", DisplayKMB(stats[0], 0));
+        Print(32, "  misses=%s", DisplayKMB(stats[1], 0));
+        Print(32, "  evictions=%s", DisplayKMB(stats[2], 0));
+        Print(32, "  errors=%d\n", (int) stats[3]);
+        if (stats[0] + stats[1])
+          Print(32, "  hit rate=%.1f%%\n",
+              100.0 * stats[0] / (stats[0] + stats[1]));
+        Print(32, "  preloaded %d table files, %s bytes\n", (int) stats[7],
+            DisplayKMB(stats[6], 0));
+      } else if (OptionMatch("preload", args[1])) {
+        int i;
+
+        if (thinking || pondering)
+          return 2;
+        for (i = 2; i < nargs; i++)
+          Print(32, "%s: %d table files resident\n", args[i],
+              IPreloadTb(args[i]));
+      } else if (nargs == 2)
         EGTBlimit = Min(atoi(args[1]), 5);
     }
   }
@@ -929,17 +962,18 @@ int Option(TREE * RESTRICT tree) {
         return 1;
       }
       hash_table_size = ((1ull) << MSB(new_hash_size)) / 16;
-      AlignedRemalloc((void *) ((void *) &hash_table), 64,
+      LargeRemalloc((void *) ((void *) &hash_table),
           hash_table_size * sizeof(HASH_ENTRY));
       if (!hash_table) {
-        printf("AlignedRemalloc() failed, not enough memory.\n");
+        printf("LargeRemalloc() failed, not enough memory.\n");
         exit(1);
       }
       hash_mask = (hash_table_size - 1) & ~3;
     }
     Print(32, "hash table memory = %s bytes",
         DisplayKMB(hash_table_size * sizeof(HASH_ENTRY), 1));
-    Print(32, " (%s entries).\n", DisplayKMB(hash_table_size, 1));
+    Print(32, " (%s entries, %s).\n", DisplayKMB(hash_table_size, 1),
+        LargePages(hash_table));
     InitializeHashTables(old_hash_size != hash_table_size);
   }
 /*
@@ -955,7 +989,12 @@ int Option(TREE * RESTRICT tree) {
  *                                                          *
  *  the only restriction is that the path hash table must   *
  *  have a perfect power of 2 entries.  The value entered   *
- *  will be rounded down to meet that requirement.          *
+ *  will be rounded down to meet that requirement.  Entries *
+ *  are grouped into clusters of 16, so under heavy SMP     *
+ *  load a larger table keeps more complete PVs around.     *
+ *                                                          *
+ *  This, "hash" and "hashp" all report whether the table   *
+ *  ended up backed by huge pages (see LargeMalloc()).      *
  *                                                          *
  ************************************************************
  */
@@ -971,10 +1010,10 @@ int Option(TREE * RESTRICT tree) {
         return 1;
       }
       hash_path_size = ((1ull) << MSB(new_hash_size / sizeof(HPATH_ENTRY)));
-      AlignedRemalloc((void *) ((void *) &hash_path), 64,
+      LargeRemalloc((void *) ((void *) &hash_path),
           sizeof(HPATH_ENTRY) * hash_path_size);
       if (!hash_path) {
-        printf("AlignedRemalloc() failed, not enough memory.\n");
+        printf("LargeRemalloc() failed, not enough memory.\n");
         hash_path_size = 0;
         hash_path = 0;
       }
@@ -982,7 +1021,8 @@ int Option(TREE * RESTRICT tree) {
     }
     Print(32, "hash path table memory = %s bytes",
         DisplayKMB(hash_path_size * sizeof(HPATH_ENTRY), 1));
-    Print(32, " (%s entries).\n", DisplayKMB(hash_path_size, 1));
+    Print(32, " (%s entries, %s).\n", DisplayKMB(hash_path_size, 1),
+        LargePages(hash_path));
     InitializeHashTables(old_hash_size != hash_path_size);
   }
 /*
@@ -1008,17 +1048,18 @@ int Option(TREE * RESTRICT tree) {
       }
       pawn_hash_table_size =
           1ull << MSB(new_hash_size / sizeof(PAWN_HASH_ENTRY));
-      AlignedRemalloc((void *) ((void *) &pawn_hash_table), 64,
+      LargeRemalloc((void *) ((void *) &pawn_hash_table),
           sizeof(PAWN_HASH_ENTRY) * pawn_hash_table_size);
       if (!pawn_hash_table) {
-        printf("AlignedRemalloc() failed, not enough memory.\n");
+        printf("LargeRemalloc() failed, not enough memory.\n");
         exit(1);
       }
       pawn_hash_mask = pawn_hash_table_size - 1;
     }
     Print(32, "pawn hash table memory = %s bytes",
         DisplayKMB(pawn_hash_table_size * sizeof(PAWN_HASH_ENTRY), 1));
-    Print(32, " (%s entries).\n", DisplayKMB(pawn_hash_table_size, 1));
+    Print(32, " (%s entries, %s).\n", DisplayKMB(pawn_hash_table_size, 1),
+        LargePages(pawn_hash_table));
     InitializeHashTables(old_hash_size != pawn_hash_table_size);
   }
 /*
@@ -1946,6 +1987,7 @@ int Option(TREE * RESTRICT tree) {
       Print(32, "parallel threads terminated.\n");
       for (proc = 1; proc < CPUS; proc++)
         thread[proc].terminate = 1;
+      ThreadWake();
     }
     NewGame(0);
     return 3;
@@ -3496,6 +3538,12 @@ int Option(TREE * RESTRICT tree) {
  *   the root is more efficient, but might slow finding the *
  *   move in some test positions.                           *
  *                                                          *
+ *   "smpspin" sets how many times an idle thread (or one   *
+ *   waiting on lock_smp) spins before it blocks in the     *
+ *   kernel (a futex on Linux) until there is work to do.   *
+ *   Zero (the default) never blocks, which gives the best  *
+ *   split latency on a dedicated machine.                  *
+ *                                                          *
  *   "smpgsd" sets the minimum depth remaining at which a   *
  *   gratuitous split can be done.                          *
  *                                                          *
@@ -3563,6 +3611,7 @@ int Option(TREE * RESTRICT tree) {
     for (proc = 1; proc < CPUS; proc++)
       if (proc >= smp_max_threads)
         thread[proc].terminate = 1;
+    ThreadWake();
   } else if (OptionMatch("smpnice", *args)) {
     if (nargs < 2) {
       printf("usage:  smpnice 0|1\n");
@@ -3593,6 +3642,17 @@ int Option(TREE * RESTRICT tree) {
       Print(32, "SMP search split at ply >= 1.\n");
     else
       Print(32, "SMP search split at ply > 1.\n");
+  } else if (OptionMatch("smpspin", *args)) {
+    if (nargs < 2) {
+      printf("usage:  smpspin <n>\n");
+      return 1;
+    }
+    smp_spin_limit = atoi(args[1]);
+    if (smp_spin_limit)
+      Print(32, "SMP idle threads block after %u spins.\n", smp_spin_limit);
+    else
+      Print(32, "SMP idle threads spin without blocking.\n");
+    ThreadWake();
   } else if (OptionMatch("smpgsl", *args)) {
     if (nargs < 2) {
       printf("usage:  smpgsl <n>\n");
@@ -3738,6 +3798,35 @@ int Option(TREE * RESTRICT tree) {
     if (unsolved)
       fclose(unsolved);
   }
+/*
+ ************************************************************
+ *                                                          *
+ *  "testmt" command runs an EPD test suite using several   *
+ *  single-threaded searches in parallel, one per process,  *
+ *  and optionally writes per-position results (time,       *
+ *  nodes and depth to solution) to a CSV or JSON file.     *
+ *                                                          *
+ ************************************************************
+ */
+  else if (OptionMatch("testmt", *args)) {
+    if (thinking || pondering)
+      return 2;
+    nargs = ReadParse(buffer, args, " \t;=");
+    if (nargs < 3) {
+      printf("usage:  testmt <filename> <processes> [exitcnt] [results]\n");
+      return 1;
+    }
+#if defined(UNIX)
+    if (nargs > 3)
+      early_exit = atoi(args[3]);
+    TestParallel(args[1], atoi(args[2]), (nargs > 4) ? args[4] : 0);
+    ponder_move = 0;
+    last_pv.pathd = 0;
+    last_pv.pathl = 0;
+#else
+    printf("testmt is only supported on Unix systems.\n");
+#endif
+  }
 /*
  ************************************************************
  *                                                          *
@@ -622,7 +622,7 @@ int SearchMoveList(TREE * RESTRICT tree, int ply, int depth, int wtm,
       }
 #if (CPUS > 1)
       if (mode == parallel) {
-        Lock(lock_smp);
+        LockAdaptive(lock_smp);
         Lock(tree->parent->lock);
         if (!tree->stop) {
           int proc;
@@ -633,7 +633,7 @@ int SearchMoveList(TREE * RESTRICT tree, int ply, int depth, int wtm,
               ThreadStop(tree->parent->siblings[proc]);
         }
         Unlock(tree->parent->lock);
-        Unlock(lock_smp);
+        UnlockAdaptive(lock_smp);
         return value;
       }
 #endif
@@ -415,3 +415,366 @@ void TestEPD(char *filename, FILE * unsolved, int screen, int margin) {
   input_stream = stdin;
   early_exit = 99;
 }
+
+#if defined(UNIX)
+#  include <sys/mman.h>
+#  include <sys/wait.h>
+/* last modified 10/19/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   TestParallel() runs an EPD test suite (same format as TestEPD()) using    *
+ *   several independent single-threaded searches at once, rather than one    *
+ *   position at a time.  Crafty keeps far too much of the search state in     *
+ *   globals to run more than one search per process, so we simply fork()     *
+ *   one child per search.  The children share a position counter and a table  *
+ *   of results in shared memory.  Each child grabs the next unsearched        *
+ *   position, searches it with the current time/depth limits and fills in    *
+ *   its result, until the suite is exhausted.  This is very effective for     *
+ *   big suites, since positions are completely independent.                  *
+ *                                                                             *
+ *   For every position we record the time, nodes and depth of the complete   *
+ *   search, plus the time, nodes and depth at the start of the final run of   *
+ *   iterations that had the correct move (see Iterate()), which is what we    *
+ *   call "time to solution".  If a results file name is given, these are     *
+ *   written there, as JSON if the name ends in ".json", as CSV otherwise.     *
+ *                                                                             *
+ *   Note that each child gets its own copy of the hash tables as soon as it   *
+ *   clears them, so the hash size should be chosen with that in mind.         *
+ *                                                                             *
+ *******************************************************************************
+ */
+static void TestParallelString(FILE * output, char *text, int json) {
+  char *c;
+
+/*
+ ************************************************************
+ *                                                          *
+ *  EPD ids are free text, so quote them properly:  JSON    *
+ *  escapes quotes, backslashes and control characters,     *
+ *  CSV doubles any embedded quote.                         *
+ *                                                          *
+ ************************************************************
+ */
+  fputc('"', output);
+  for (c = text; *c; c++) {
+    if (json && (*c == '"' || *c == '\\'))
+      fprintf(output, "\\%c", *c);
+    else if (json && (unsigned char) *c < 0x20)
+      fprintf(output, "\\u%04x", (unsigned char) *c);
+    else if (!json && *c == '"')
+      fprintf(output, "\"\"");
+    else
+      fputc(*c, output);
+  }
+  fputc('"', output);
+}
+
+static void TestParallelSearch(char *epd, TEST_RESULT * result) {
+  TREE *const tree = block[0];
+  int i, move, correct;
+  char *mvs, *title, *delim;
+
+/*
+ ************************************************************
+ *                                                          *
+ *  Parse the EPD record exactly as TestEPD() does, then    *
+ *  set up the position and the solution list.              *
+ *                                                          *
+ ************************************************************
+ */
+  strcpy(buffer, epd);
+  delim = strchr(buffer, '\n');
+  if (delim)
+    *delim = 0;
+  delim = strchr(buffer, '\r');
+  if (delim)
+    *delim = ' ';
+  mvs = strstr(buffer, " sd ");
+  if (mvs) {
+    search_depth = atoi(mvs + 3);
+    *(mvs - 1) = 0;
+  }
+  mvs = strstr(buffer, " bm ");
+  if (!mvs)
+    mvs = strstr(buffer, " am ");
+  if (mvs)
+    mvs++;
+  title = strstr(buffer, "id");
+  if (mvs)
+    *(mvs - 1) = 0;
+  if (title) {
+    *(title - 1) = 0;
+    title = strchr(title, '\"');
+    if (title) {
+      title++;
+      if (strchr(title, '\"'))
+        *strchr(title, '\"') = 0;
+      strncpy(result->id, title, sizeof(result->id) - 1);
+    }
+  }
+  Option(tree);
+  number_of_solutions = 0;
+  solution_type = 0;
+  if (mvs) {
+    nargs = ReadParse(mvs, args, " \t;");
+    if (!strcmp(args[0], "am"))
+      solution_type = 1;
+    for (i = 1; i < nargs; i++) {
+      if (!strcmp(args[i], "c0"))
+        break;
+      move = InputMove(tree, 0, game_wtm, 0, 0, args[i]);
+      if (move && number_of_solutions < 10)
+        solutions[number_of_solutions++] = move;
+    }
+  }
+/*
+ ************************************************************
+ *                                                          *
+ *  Search and record the results.                          *
+ *                                                          *
+ ************************************************************
+ */
+  InitializeHashTables(0);
+  last_pv.pathd = 0;
+  thinking = 1;
+  tree->status[1] = tree->status[0];
+  Iterate(game_wtm, think, 0);
+  thinking = 0;
+  move = tree->pv[1].path[1] & 0x001fffff;
+  correct = solution_type;
+  for (i = 0; i < number_of_solutions; i++) {
+    if (!solution_type) {
+      if (solutions[i] == move)
+        correct = 1;
+    } else if (solutions[i] == move)
+      correct = 0;
+  }
+  if (move)
+    strncpy(result->move, OutputMove(tree, 0, game_wtm, move),
+        sizeof(result->move) - 1);
+  result->correct = correct;
+  result->score = last_root_value;
+  result->depth = iteration;
+  result->time = end_time - start_time;
+  result->nodes = tree->nodes_searched;
+  if (correct && solution_depth) {
+    result->solution_depth = solution_depth;
+    result->solution_time = solution_time;
+    result->solution_nodes = solution_nodes;
+  }
+  result->done = 1;
+}
+
+void TestParallel(char *filename, int procs, char *results) {
+  FILE *test_input, *output;
+  TEST_RESULT *result;
+  uint64_t nodes = 0, solution_total_nodes = 0;
+  size_t size;
+  volatile int *next;
+  char **epd = 0, *json;
+  int i, p, n = 0, max = 0, running = 0, done, right = 0, time = 0;
+  int solution_total_time = 0, avg_depth = 0, k, proc;
+  pid_t pid;
+
+/*
+ ************************************************************
+ *                                                          *
+ *  Read the whole suite into memory so that the children   *
+ *  can index it directly.                                  *
+ *                                                          *
+ ************************************************************
+ */
+  if (!(test_input = fopen(filename, "r"))) {
+    printf("file %s does not exist.\n", filename);
+    return;
+  }
+  while (fgets(buffer, 4096, test_input)) {
+    if (StrCnt(buffer, '/') < 7)
+      continue;
+    if (n == max) {
+      max = max ? 2 * max : 256;
+      epd = (char **) realloc(epd, max * sizeof(char *));
+    }
+    epd[n] = (char *) malloc(strlen(buffer) + 1);
+    strcpy(epd[n++], buffer);
+  }
+  fclose(test_input);
+  if (!n) {
+    printf("file %s contains no EPD records.\n", filename);
+    free(epd);
+    return;
+  }
+  procs = Max(1, Min(procs, n));
+  size = n * sizeof(TEST_RESULT) + 64;
+  result =
+      (TEST_RESULT *) mmap(0, size, PROT_READ | PROT_WRITE,
+      MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (result == MAP_FAILED) {
+    perror("TestParallel() mmap() error: ");
+    for (i = 0; i < n; i++)
+      free(epd[i]);
+    free(epd);
+    return;
+  }
+  next = (volatile int *) (result + n);
+  if (book_file) {
+    fclose(book_file);
+    book_file = 0;
+  }
+  if (books_file) {
+    fclose(books_file);
+    books_file = 0;
+  }
+/*
+ ************************************************************
+ *                                                          *
+ *  Get rid of any idle smp threads, since fork() would not *
+ *  copy them anyway, then start one child per search.  A   *
+ *  child discards all normal output, reads its input from  *
+ *  /dev/null so it cannot steal commands meant for the     *
+ *  parent, runs single-threaded and keeps taking positions *
+ *  until none are left.                                    *
+ *                                                          *
+ ************************************************************
+ */
+  if (smp_threads) {
+    for (proc = 1; proc < CPUS; proc++)
+      thread[proc].terminate = 1;
+    ThreadWake();
+    while (smp_threads);
+  }
+  Print(4095, "searching %d positions using %d processes.\n", n, procs);
+  fflush(stdout);
+  if (log_file)
+    fflush(log_file);
+  for (p = 0; p < procs; p++) {
+    pid = fork();
+    if (pid == 0) {
+      if (!freopen("/dev/null", "w", stdout))
+        _exit(1);
+      if (!freopen("/dev/null", "r", stdin))
+        _exit(1);
+      log_file = 0;
+      smp_max_threads = 0;
+      while ((k = __sync_fetch_and_add(next, 1)) < n)
+        TestParallelSearch(epd[k], &result[k]);
+      _exit(0);
+    }
+    if (pid < 0) {
+      perror("TestParallel() fork() error: ");
+      break;
+    }
+    running++;
+  }
+  while (running) {
+    if (waitpid(-1, 0, WNOHANG) > 0) {
+      running--;
+      continue;
+    }
+    for (done = 0, i = 0; i < n; i++)
+      done += result[i].done;
+    printf("%d/%d positions done          \r", done, n);
+    fflush(stdout);
+    sleep(1);
+  }
+  printf("\n");
+/*
+ ************************************************************
+ *                                                          *
+ *  Now print the results and write the results file.       *
+ *                                                          *
+ ************************************************************
+ */
+  output = 0;
+  json = 0;
+  if (results) {
+    if (!(output = fopen(results, "w")))
+      printf("file %s cannot be opened for write.\n", results);
+    json = strstr(results, ".json");
+    if (json && json[5])
+      json = 0;
+  }
+  if (output) {
+    if (json)
+      fprintf(output, "[\n");
+    else
+      fprintf(output, "position,id,correct,move,score,depth,time,nodes,"
+          "solution_depth,solution_time,solution_nodes\n");
+  }
+  for (done = 0, i = 0; i < n; i++) {
+    if (!result[i].done)
+      continue;
+    done++;
+    right += result[i].correct;
+    nodes += result[i].nodes;
+    time += result[i].time;
+    avg_depth += result[i].depth;
+    if (result[i].correct) {
+      solution_total_time += result[i].solution_time;
+      solution_total_nodes += result[i].solution_nodes;
+    }
+    Print(4095, "%4d %-24s %-10s %-8s depth=%-3d time=%-8s nodes=%" PRIu64
+        "\n", i + 1, result[i].id, result[i].move,
+        result[i].correct ? "correct" : "wrong", result[i].depth,
+        DisplayTime(result[i].time), result[i].nodes);
+    if (!output)
+      continue;
+    if (json) {
+      fprintf(output, "%s  {\"position\": %d, \"id\": ",
+          (done > 1) ? ",\n" : "", i + 1);
+      TestParallelString(output, result[i].id, 1);
+      fprintf(output,
+          ", \"correct\": %s, "
+          "\"move\": \"%s\", \"score\": %d, \"depth\": %d, \"time\": %.2f, "
+          "\"nodes\": %" PRIu64 ", \"solution_depth\": %d, "
+          "\"solution_time\": %.2f, \"solution_nodes\": %" PRIu64 "}",
+          result[i].correct ? "true" : "false", result[i].move,
+          result[i].score, result[i].depth, result[i].time / 100.0,
+          result[i].nodes, result[i].solution_depth,
+          result[i].solution_time / 100.0, result[i].solution_nodes);
+    } else {
+      fprintf(output, "%d,", i + 1);
+      TestParallelString(output, result[i].id, 0);
+      fprintf(output, ",%d,%s,%d,%d,%.2f,%" PRIu64 ",%d,%.2f,%" PRIu64 "\n",
+          result[i].correct, result[i].move, result[i].score,
+          result[i].depth, result[i].time / 100.0, result[i].nodes,
+          result[i].solution_depth, result[i].solution_time / 100.0,
+          result[i].solution_nodes);
+    }
+  }
+  if (output) {
+    if (json)
+      fprintf(output, "\n]\n");
+    fclose(output);
+  }
+  if (done) {
+    Print(4095, "\n\n\n");
+    Print(4095, "test results summary:\n\n");
+    Print(4095, "total positions searched..........%12d\n", done);
+    Print(4095, "number right......................%12d\n", right);
+    Print(4095, "number wrong......................%12d\n", done - right);
+    Print(4095, "percentage right..................%12d\n",
+        right * 100 / done);
+    Print(4095, "percentage wrong..................%12d\n",
+        (done - right) * 100 / done);
+    Print(4095, "total nodes searched..............%12" PRIu64 "\n", nodes);
+    Print(4095, "average search depth..............%12.1f\n",
+        (float) avg_depth / done);
+    Print(4095, "total search time.................%12s\n",
+        DisplayTime(time));
+    if (right) {
+      Print(4095, "average time to solution..........%12s\n",
+          DisplayTime(solution_total_time / right));
+      Print(4095, "average nodes to solution.........%12" PRIu64 "\n",
+          solution_total_nodes / right);
+    }
+  }
+  munmap((void *) result, size);
+  for (i = 0; i < n; i++)
+    free(epd[i]);
+  free(epd);
+  input_stream = stdin;
+  early_exit = 99;
+}
+#endif
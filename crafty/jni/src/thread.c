@@ -2,7 +2,7 @@
 #include "data.h"
 #include "epdglue.h"
 #if (CPUS > 1)
-/* modified 11/04/15 */
+/* modified 10/19/26 */
 /*
  *******************************************************************************
  *                                                                             *
@@ -210,6 +210,7 @@ int Split(TREE * RESTRICT tree) {
   tree->joinable = 1;
   parallel_splits++;
   smp_split = 0;
+  ThreadWake();
   tend = ReadClock();
   thread[tree->thread_id].idle += tend - tstart;
 /*
@@ -386,14 +387,14 @@ void *STDCALL ThreadInit(void *t) {
   ThreadMalloc((uint64_t) tid);
 #  endif
   thread[tid].blocks = 0xffffffffffffffffull;
-  Lock(lock_smp);
+  LockAdaptive(lock_smp);
   initialized_threads++;
-  Unlock(lock_smp);
+  UnlockAdaptive(lock_smp);
   WaitForAllThreadsInitialized();
   ThreadWait(tid, (TREE *) 0);
-  Lock(lock_smp);
+  LockAdaptive(lock_smp);
   smp_threads--;
-  Unlock(lock_smp);
+  UnlockAdaptive(lock_smp);
   return 0;
 }
 
@@ -624,7 +625,7 @@ void ThreadTrace(TREE * RESTRICT tree, int depth, int brief) {
   Unlock(tree->lock);
 }
 
-/* modified 11/04/15 */
+/* modified 10/19/26 */
 /*
  *******************************************************************************
  *                                                                             *
@@ -644,10 +645,18 @@ void ThreadTrace(TREE * RESTRICT tree, int depth, int brief) {
  *   and clean things up.  The call to here in Split() passes this block       *
  *   address while threads that are helping get here with a zero.              *
  *                                                                             *
+ *   If smp_spin_limit is non-zero (smpspin=n) an idle thread only spins for   *
+ *   n trips through the loop below.  After that it blocks on smp_idle_seq     *
+ *   until ThreadWake() tells it that something it might care about changed    *
+ *   (a new split point, a helper leaving a split point, or terminate being    *
+ *   set).  This keeps idle threads from burning a whole core each while       *
+ *   pondering or while sharing the machine with other programs.               *
+ *                                                                             *
  *******************************************************************************
  */
 int ThreadWait(int tid, TREE * RESTRICT waiting) {
-  int value, tstart, tend;
+  int value, tstart, tend, seq = 0, sleeping;
+  unsigned int spins;
 
 /*
  ************************************************************
@@ -667,13 +676,34 @@ int ThreadWait(int tid, TREE * RESTRICT waiting) {
  *  falls through the while spin loop below because its     *
  *  "tree" pointer is already non-zero.                     *
  *                                                          *
+ *  Once we have spun smp_spin_limit times we register as a *
+ *  sleeper and read smp_idle_seq, then test the loop       *
+ *  condition one more time before blocking.  ThreadWake()  *
+ *  bumps smp_idle_seq before it looks at the sleeper count *
+ *  so either we see its change or it sees us and wakes us. *
+ *  The wait also times out, just to be safe.               *
+ *                                                          *
  ************************************************************
  */
   while (1) {
     tstart = ReadClock();
+    spins = 0;
+    sleeping = 0;
     while (!thread[tid].tree && (!waiting || waiting->nprocs) && !Join(tid) &&
-        !thread[tid].terminate)
-      Pause();
+        !thread[tid].terminate) {
+      if (!smp_spin_limit || ++spins < smp_spin_limit)
+        Pause();
+      else if (!sleeping) {
+        AtomicAdd(smp_idle_sleepers, 1);
+        sleeping = 1;
+        seq = smp_idle_seq;
+      } else {
+        FutexWait(&smp_idle_seq, seq, 10000);
+        seq = smp_idle_seq;
+      }
+    }
+    if (sleeping)
+      AtomicAdd(smp_idle_sleepers, -1);
     tend = ReadClock();
     if (!thread[tid].tree)
       thread[tid].tree = waiting;
@@ -714,11 +744,29 @@ int ThreadWait(int tid, TREE * RESTRICT waiting) {
     thread[tid].tree->parent->siblings[tid] = 0;
     Unlock(thread[tid].tree->parent->lock);
     thread[tid].tree = 0;
+    ThreadWake();
     tend = ReadClock();
     thread[tid].idle += tend - tstart;
   }
 }
 
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   ThreadWake() is called whenever something changes that a thread blocked   *
+ *   in ThreadWait() needs to see.  It is nearly free when nobody is blocked,  *
+ *   since the futex wake system call is only made if there are sleepers.      *
+ *                                                                             *
+ *******************************************************************************
+ */
+void ThreadWake(void) {
+  if (!smp_spin_limit && !smp_idle_sleepers)
+    return;
+  AtomicAdd(smp_idle_seq, 1);
+  if (smp_idle_sleepers)
+    FutexWake(&smp_idle_seq, CPUS);
+}
+
 /* modified 11/04/15 */
 /*
  *******************************************************************************
@@ -982,4 +1030,7 @@ void ThreadMalloc(int64_t tid) {
   }
 }
 #  endif
+#else
+void ThreadWake(void) {
+}
 #endif
@@ -10,6 +10,7 @@
 #  include <sys/wait.h>
 #  include <sys/times.h>
 #  include <sys/time.h>
+#  include <sys/mman.h>
 #else
 #  include <windows.h>
 #  include <winbase.h>
@@ -473,6 +474,7 @@ void CraftyExit(int exit_type) {
 
   for (proc = 1; proc < CPUS; proc++)
     thread[proc].terminate = 1;
+  ThreadWake();
   while (smp_threads);
   exit(exit_type);
 }
@@ -1570,6 +1572,119 @@ int KingPawnSquare(int pawn, int king, int queen, int ptm) {
   return pdist >= kdist;
 }
 
+/* last modified 10/19/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   LargeMalloc() is used to allocate the three big hash tables (trans/ref,   *
+ *   path and pawn).  With multi-gigabyte tables nearly every probe is a TLB   *
+ *   miss when the table is backed by 4K pages, so on Linux we first try to    *
+ *   get explicit huge pages (MAP_HUGETLB, which requires that the admin has   *
+ *   reserved some in /proc/sys/vm/nr_hugepages).  If that fails, we map the   *
+ *   memory on a 2M boundary and ask for transparent huge pages instead, which *
+ *   the kernel will honor when it can.  Other systems simply use the normal   *
+ *   AlignedMalloc() approach, as does any allocation beyond the first         *
+ *   MAX_LARGE_SEGMENTS, since those are the only mappings we can track.  The  *
+ *   memory is always 64-byte aligned so that a hash bucket never spans two    *
+ *   cache lines.  LargePages() returns a short description of what we         *
+ *   actually got, for the "hash" family of commands.                          *
+ *                                                                             *
+ *******************************************************************************
+ */
+#if defined(UNIX)
+static int LargeMap(void **pointer, size_t * size) {
+  const size_t huge = 2 * 1024 * 1024;
+  size_t rounded = (*size + huge - 1) & ~(huge - 1), lead;
+  char *base;
+
+#  if defined(MAP_HUGETLB)
+  base =
+      mmap(0, rounded, PROT_READ | PROT_WRITE,
+      MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+  if (base != MAP_FAILED) {
+    *pointer = base;
+    *size = rounded;
+    return 2;
+  }
+#  endif
+  base =
+      mmap(0, rounded + huge, PROT_READ | PROT_WRITE,
+      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (base == MAP_FAILED) {
+    *pointer = 0;
+    *size = 0;
+    return 0;
+  }
+  lead = (huge - ((uintptr_t) base & (huge - 1))) & (huge - 1);
+  if (lead)
+    munmap(base, lead);
+  munmap(base + lead + rounded, huge - lead);
+  *pointer = base + lead;
+  *size = rounded;
+#  if defined(MADV_HUGEPAGE)
+  if (!madvise(*pointer, rounded, MADV_HUGEPAGE))
+    return 1;
+#  endif
+  return 0;
+}
+#endif
+
+void LargeMalloc(void **pointer, size_t size) {
+#if defined(UNIX)
+  if (nlarge_segments == MAX_LARGE_SEGMENTS) {
+    AlignedMalloc(pointer, 64, size);
+    return;
+  }
+  large_pages[nlarge_segments] = LargeMap(pointer, &size);
+  large_segments[nlarge_segments] = *pointer;
+  large_sizes[nlarge_segments] = size;
+  nlarge_segments++;
+#else
+  AlignedMalloc(pointer, 64, size);
+#endif
+}
+
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   LargeRemalloc() is used to change the size of a memory block that has     *
+ *   previously been allocated using LargeMalloc().                            *
+ *                                                                             *
+ *******************************************************************************
+ */
+void LargeRemalloc(void **pointer, size_t size) {
+#if defined(UNIX)
+  int i;
+
+  for (i = 0; i < nlarge_segments; i++)
+    if (large_segments[i] == *pointer)
+      break;
+  if (i == nlarge_segments) {
+    AlignedRemalloc(pointer, 64, size);
+    return;
+  }
+  if (large_segments[i])
+    munmap(large_segments[i], large_sizes[i]);
+  large_pages[i] = LargeMap(pointer, &size);
+  large_segments[i] = *pointer;
+  large_sizes[i] = size;
+#else
+  AlignedRemalloc(pointer, 64, size);
+#endif
+}
+
+char *LargePages(void *pointer) {
+  static char *types[3] = { "4K pages", "transparent huge pages",
+    "2M huge pages"
+  };
+  int i;
+
+  for (i = 0; i < nlarge_segments; i++)
+    if (large_segments[i] == pointer)
+      return types[large_pages[i]];
+  return types[0];
+}
+
 /* last modified 02/26/14 */
 /*
  *******************************************************************************
@@ -2683,7 +2798,7 @@ static void WinNumaInit(void) {
   DWORD dwCPU;
 
   if (!fThreadsInitialized) {
-    Lock(lock_smp);
+    LockAdaptive(lock_smp);
     if (!fThreadsInitialized) {
       printf("\nInitializing multiple threads.\n");
       fThreadsInitialized = TRUE;
@@ -2741,7 +2856,7 @@ static void WinNumaInit(void) {
       } else
         printf("System is SMP, not NUMA.\n");
     }
-    Unlock(lock_smp);
+    UnlockAdaptive(lock_smp);
   }
 }
 
@@ -244,8 +244,8 @@ void ValidatePosition(TREE * RESTRICT tree, int ply, int move, char *caller) {
  ************************************************************
  */
   if (error) {
-    Lock(lock_smp);
-    Unlock(lock_smp);
+    LockAdaptive(lock_smp);
+    UnlockAdaptive(lock_smp);
     Print(2048, "ply=%d\n", tree->ply);
     Print(2048, "phase[%d]=%d  current move:\n", ply, tree->phase[ply]);
     DisplayChessMove("move=", move);
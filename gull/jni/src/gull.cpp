@@ -3,6 +3,7 @@ const void* Console = 0;
 #include <xmmintrin.h>
 #include <cmath>
 #include <cstring>
+#include <cstddef>
 #include <cpuid.h>
 #include <stdio.h>
 
@@ -19,6 +20,18 @@ const void* Console = 0;
 #ifdef UNIX
 #include <unistd.h>
 #include <sys/poll.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <errno.h>
+#include <time.h>
+#include <inttypes.h>
+#ifdef __linux__
+#include <sys/prctl.h>
+#endif
 #else
 #include "windows.h"
 #endif
@@ -37,9 +50,6 @@ const void* Console = 0;
 #undef EXPLAIN_EVAL
 
 #define LARGE_PAGES
-#ifdef UNIX
-	#undef LARGE_PAGES
-#endif
 
 #define MP_NPS
 //#undef MP_NPS
@@ -487,7 +497,11 @@ typedef struct
 } GPawnEntry;
 #ifndef TUNER
 #define pawn_hash_size (1024 * 1024)
+#ifdef UNIX
+GPawnEntry * PawnHash = NULL;
+#else
 alignas(64) GPawnEntry PawnHash[pawn_hash_size];
+#endif
 #else
 #define pawn_hash_size (32 * 1024)
 alignas(64) GPawnEntry PawnHashOne[pawn_hash_size];
@@ -561,6 +575,8 @@ typedef struct
 #endif
 } GMaterial;
 GMaterial * Material;
+sint16 * MaterialShift = NULL; // score corrections per material index, as written by pgn_stat()
+uint64_t MaterialShiftKey = 0;
 #define FlagSingleBishop_w (1 << 0)
 #define FlagSingleBishop_b (1 << 1)
 #define FlagCallEvalEndgame_w (1 << 2)
@@ -715,7 +731,11 @@ int RecordGames = 0;
 char RecordString[65536], PosStr[256], *Buffer;
 FILE * frec;
 #endif
+#ifdef UNIX
+#define GullCpp "./gull.cpp"
+#else
 #define GullCpp "C:/Users/Administrator/Documents/Visual Studio 2010/Projects/Gull/Gull/Gull.cpp"
+#endif
 
 #define ArrayIndex(width,row,column) (((row) * (width)) + (column))
 #ifndef TUNER
@@ -1027,7 +1047,11 @@ const int KingAttackScale[16] = {0, 1, 4, 9, 16, 25, 36, 49, 64, 64, 64, 64, 64,
 #endif
 
 int PrN = 1, CPUs = 1, HT = 0, parent = 1, child = 0, WinParId, Id = 0, ResetHash = 1, NewPrN = 0;
+#ifdef UNIX
+pid_t ChildPr[MaxPrN];
+#else
 HANDLE ChildPr[MaxPrN];
+#endif
 #define SplitDepth 10
 #define SplitDepthPV 4
 #define MaxSplitPoints 64 // mustn't exceed 64
@@ -1049,6 +1073,10 @@ typedef struct
 	volatile uint8 reduced_depth, research_depth, stage, ext, id, flags;
 } GMove;
 
+#ifdef UNIX
+typedef int LONG;
+#endif
+
 typedef struct
 {
 	volatile LONG lock;
@@ -1079,8 +1107,33 @@ GSMPI * Smpi;
 
 jmp_buf CheckJump;
 
+#ifdef UNIX
+#define I64 PRId64
+#else
+#define I64 "I64d"
+#endif
+
+#ifdef UNIX
+int64_t SharedMapSize = 0, HashMapSize = 0, PawnHashMapSize = 0;
+int64_t SharedPageSize = 0, HashPageSize = 0, PawnHashPageSize = 0;
+int ReportPages = 0; // page sizes to report before the next readyok: ReportHashPages, ReportSharedPages
+#define ReportHashPages 1
+#define ReportSharedPages 2
+#else
 HANDLE SHARED = NULL, HASH = NULL;
+#endif
 
+#ifdef UNIX
+#define SET_BIT(var,bit) (__atomic_fetch_or(&(var),1 << (bit),__ATOMIC_SEQ_CST))
+#define SET_BIT_64(var,bit) (__atomic_fetch_or(&(var),Bit(bit),__ATOMIC_SEQ_CST));
+#define ZERO_BIT_64(var,bit) (__atomic_fetch_and(&(var),~Bit(bit),__ATOMIC_SEQ_CST));
+#define TEST_RESET_BIT(var,bit) ((__atomic_fetch_and(&(var),~Bit(bit),__ATOMIC_SEQ_CST) >> (bit)) & 1)
+#define TEST_RESET(var) (__atomic_exchange_n(&(var),0,__ATOMIC_SEQ_CST))
+#define SET(var,value) (__atomic_exchange_n(&(var),value,__ATOMIC_SEQ_CST))
+
+#define LOCK(lock) {while (__atomic_exchange_n(&(lock),1,__ATOMIC_ACQUIRE)) _mm_pause();}
+#define UNLOCK(lock) {__atomic_store_n(&(lock),0,__ATOMIC_RELEASE);}
+#else
 #ifndef W32_BUILD
 #define SET_BIT(var,bit) (InterlockedOr(&(var),1 << (bit)))
 #define SET_BIT_64(var,bit) (InterlockedOr64(&(var),Bit(bit)));
@@ -1098,6 +1151,7 @@ HANDLE SHARED = NULL, HASH = NULL;
 
 #define LOCK(lock) {while (InterlockedCompareExchange(&(lock),1,0)) _mm_pause();}
 #define UNLOCK(lock) {SET(lock,0);}
+#endif
 
 // END SMP
 
@@ -1174,6 +1228,7 @@ typedef struct
 	int wins, draws, losses;
 } GMatchInfo;
 GMatchInfo MatchInfo[1] = {(0, 0, 0)};
+#define MaxTunerWorkers 256
 
 char Fen[65536][128];
 int opening_positions = 0;
@@ -1372,7 +1427,7 @@ void init_variables()
 			strcpy(VarName[var_name_num].line, p);
 			for (j = 0; VarName[var_name_num].line[j] >= '0' && VarName[var_name_num].line[j] <= 'z'; j++);
 			VarName[var_name_num].line[j] = '\n';
-			for (k = j + 1; k < 1000; k++) VarName[var_name_num].line[k] = 0;
+			for (k = j + 1; k < 256; k++) VarName[var_name_num].line[k] = 0;
 			q = strchr(p, '+');
 			if (q != NULL) curr_ind += atoi(q + 1);
 			else curr_ind++;
@@ -1802,8 +1857,10 @@ double play_game(double * one, double * two, int depth, char * fen)
 
 	for (cnt = 0; cnt < 200 + (RecordGames ? 200 : 0); cnt++)
 	{
+#ifdef CPU_TIMING
 		GlobalTurn = Even(cnt);
-		load_eval(GlobalTurn);
+#endif
+		load_eval(Even(cnt));
 		memcpy(Data, Current, sizeof (GData));
 		Current = Data;
 		if (Even(cnt)) sdepth = depth + Odd(rand16());
@@ -1884,6 +1941,134 @@ double play_position(double * one, double * two, int depth, char * fen, GMatchIn
 	return score;
 }
 
+#ifdef UNIX
+// Local tuning on UNIX runs the client side in forked worker processes, each with its own copy of the
+// board, search and hash state. The server publishes the current command under a sequence lock and the
+// workers keep executing it; result lines are returned through a bounded lock-free queue (a ticket per
+// result), so the command/result protocol is the same as with external clients.
+#define TunerQueueSize 64
+#define TunerLineSize 65536
+
+typedef struct
+{
+	volatile int64_t seq;
+	char line[TunerLineSize];
+} GTunerSlot;
+
+typedef struct
+{
+	volatile int64_t command_seq, tail;
+	char command[TunerLineSize];
+	GTunerSlot slot[TunerQueueSize];
+} GTunerPool;
+GTunerPool * TunerPool = NULL;
+int64_t TunerHead = 0;
+int TunerWorkers = 0;
+
+void get_command();
+
+void init_tuner_pool(int workers)
+{
+	TunerPool = (GTunerPool*) mmap(NULL, sizeof (GTunerPool), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if (TunerPool == MAP_FAILED)
+	{
+		TunerPool = NULL;
+		return;
+	}
+	for (int i = 0; i < TunerQueueSize; i++) TunerPool->slot[i].seq = i;
+	fflush(NULL);
+	for (TunerWorkers = 0; TunerWorkers < Min(workers, MaxTunerWorkers); TunerWorkers++)
+	{
+		pid_t pid = fork();
+		if (pid < 0) break;
+		if (pid == 0)
+		{
+#ifdef __linux__
+			prctl(PR_SET_PDEATHSIG, SIGKILL);
+#endif
+			if (freopen("/dev/null", "w", stdout) == NULL) _exit(1);
+			Client = 1;
+			Local = 0;
+			srand(time(NULL) + 123 * getpid());
+			seed = (uint64_t) (time(NULL) + 345 * getpid()) ^ (Convert(clock(), uint64_t) << 32);
+			while (true) get_command();
+		}
+	}
+	fprintf(stdout, "%d tuner workers\n", TunerWorkers);
+}
+#endif
+
+void tuner_send(char * command)
+{
+#ifdef UNIX
+	if (TunerPool != NULL)
+	{
+		int64_t seq = TunerPool->command_seq;
+		__atomic_store_n(&TunerPool->command_seq, seq + 1, __ATOMIC_RELAXED);
+		__atomic_thread_fence(__ATOMIC_RELEASE);
+		strncpy(TunerPool->command, command, TunerLineSize - 1);
+		__atomic_store_n(&TunerPool->command_seq, seq + 2, __ATOMIC_RELEASE);
+		return;
+	}
+#endif
+	fseek(stdin, 0, SEEK_END);
+	fprintf(stdout, "%s\n", command);
+}
+
+void tuner_receive(char * result)
+{
+#ifdef UNIX
+	if (TunerPool != NULL)
+	{
+		GTunerSlot * Slot = TunerPool->slot + (TunerHead % TunerQueueSize);
+		while (__atomic_load_n(&Slot->seq, __ATOMIC_ACQUIRE) != TunerHead + 1) usleep(1000);
+		strcpy(result, Slot->line);
+		__atomic_store_n(&Slot->seq, TunerHead + TunerQueueSize, __ATOMIC_RELEASE);
+		TunerHead++;
+		return;
+	}
+#endif
+	fgets(result, 65536, stdin);
+}
+
+void tuner_get_command(char * command)
+{
+#ifdef UNIX
+	if (TunerPool != NULL)
+	{
+		while (true)
+		{
+			int64_t seq = __atomic_load_n(&TunerPool->command_seq, __ATOMIC_ACQUIRE);
+			if (seq && !Odd(seq))
+			{
+				memcpy(command, TunerPool->command, TunerLineSize);
+				__atomic_thread_fence(__ATOMIC_ACQUIRE);
+				if (__atomic_load_n(&TunerPool->command_seq, __ATOMIC_RELAXED) == seq) return;
+			}
+			usleep(1000);
+		}
+	}
+#endif
+	fgets(command, 65536, stdin);
+	fseek(stdin, 0, SEEK_END);
+}
+
+void tuner_put_result(char * result)
+{
+#ifdef UNIX
+	if (TunerPool != NULL)
+	{
+		int64_t ticket = __atomic_fetch_add(&TunerPool->tail, 1, __ATOMIC_RELAXED);
+		GTunerSlot * Slot = TunerPool->slot + (ticket % TunerQueueSize);
+		while (__atomic_load_n(&Slot->seq, __ATOMIC_ACQUIRE) != ticket) usleep(1000);
+		strncpy(Slot->line, result, TunerLineSize - 1);
+		__atomic_store_n(&Slot->seq, ticket + 1, __ATOMIC_RELEASE);
+		return;
+	}
+#endif
+	fprintf(stdout, "%s\n", result);
+}
+
 double match(double * one, double * two, int positions, int depth, GMatchInfo * MI)
 {
 	double score = 0.0;
@@ -1911,15 +2096,14 @@ int match_los(double * one, double * two, int positions, int chunk_size, int dep
 	log_list(mstring, one, active_vars, false);
 	sprintf(mstring + strlen(mstring), " Second=");
 	log_list(mstring, two, active_vars, false);
-	fseek(stdin, 0, SEEK_END);
-	fprintf(stdout, "%s\n", mstring);
+	tuner_send(mstring);
 
 	memset(MI, 0, sizeof (GMatchInfo));
 	while (pos < positions)
 	{
 		pos += chunk_size;
 start:
-		fgets(mstring, 65536, stdin);
+		tuner_receive(mstring);
 		char * p = strstr(mstring, "Number=");
 		if (p == NULL) goto start;
 		if (atoi(p + 7) != cmd_number) goto start;
@@ -2050,15 +2234,14 @@ void Gradient(double * base, double * var, int depth, int iter, int pos_per_iter
 	log_list(mstring, Var, active_vars, false);
 	sprintf(mstring + strlen(mstring), " Base=");
 	log_list(mstring, Base, active_vars, false);
-	fseek(stdin, 0, SEEK_END);
-	fprintf(stdout, "%s\n", mstring);
+	tuner_send(mstring);
 
 	while (cnt < max_positions)
 	{
 		for (j = 0; j < 4; j++)
 		{
 start:
-			fgets(mstring, 65536, stdin);
+			tuner_receive(mstring);
 			char * p = strstr(mstring, "Number=");
 			if (p == NULL) goto start;
 			if (atoi(p + 7) != cmd_number) goto start;
@@ -2154,8 +2337,7 @@ void get_command()
 	char * p;
 
 	if (RecordGames) Buffer[0] = 0;
-	fgets(mstring, 65536, stdin);
-	fseek(stdin, 0, SEEK_END);
+	tuner_get_command(mstring);
 	p = strstr(mstring, "Command=");
 	if (p == NULL) return;
 	if (!memcmp(p + 8, "gradient", 8)) mode = mode_grad;
@@ -2181,7 +2363,7 @@ void get_command()
 		memset(mstring, 0, strlen(mstring));
 		sprintf(mstring, "$ Number=%d Grad=", number);
 		log_list(mstring, Grad, active_vars, true);
-		fprintf(stdout, "%s\n", mstring);
+		tuner_put_result(mstring);
 	}
 	else if (mode == mode_match)
 	{
@@ -2198,7 +2380,7 @@ void get_command()
 		}
 		memset(mstring, 0, strlen(mstring));
 		sprintf(mstring, "$ Number=%d Result=%lf Wins=%d Draws=%d Losses=%d", number, r, MatchInfo->wins, MatchInfo->draws, MatchInfo->losses);
-		fprintf(stdout, "%s\n", mstring);
+		tuner_put_result(mstring);
 	}
 	else nodes /= 0;
 }
@@ -2249,8 +2431,6 @@ int conj_mat_index(int index, int * conj_symm, int * conj_ld, int * conj_ld_symm
 	return *conj_symm;
 }
 
-void pgn_stat()
-{
 #define elo_eval_ratio 1.0
 #define PosInRow 6
 #define ratio_from_eval(x) ratio_from_elo(elo_eval_ratio * (x))
@@ -2258,47 +2438,98 @@ void pgn_stat()
 #define est_from_ind(x) (Eval[x].score/Max(1.0,(double)Eval[x].cnt))
 #define est_from_eval(x) ((x) >= 0 ? est_from_ind(ind_from_eval(x)) : (1.0 - est_from_ind(ind_from_eval(x))))
 
-	typedef struct
-	{
-		double score;
-		double est;
-		int cnt;
-	} GStat;
-	GStat Eval[64];
-	for (int i = 0; i < 64; i++)
+typedef struct
+{
+	double score;
+	double est;
+	int cnt;
+} GStat;
+
+const char * map_file(const char * name, int64_t * size)
+{
+	const char * p = NULL;
+#ifdef UNIX
+	struct stat st;
+	int fd = open(name, O_RDONLY);
+	if (fd < 0) return NULL;
+	if (!fstat(fd, &st) && st.st_size > 0)
 	{
-		Eval[i].cnt = 0;
-		Eval[i].score = 1.0;
+		void * m = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (m != MAP_FAILED)
+		{
+			madvise(m, st.st_size, MADV_SEQUENTIAL);
+			p = (const char*) m;
+			*size = st.st_size;
+		}
 	}
-	GStat * Mat = (GStat*) malloc(TotalMat * sizeof (GStat));
-	memset(Mat, 0, TotalMat * sizeof (GStat));
-	FILE * fpgn;
-	int iter = 0;
-loop:
-	fpgn = fopen("D:/Development/G3T/games.pgn", "r");
-	if (fpgn == NULL)
+	close(fd);
+#else
+	LARGE_INTEGER file_size;
+	HANDLE file = CreateFileA(name, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (file == INVALID_HANDLE_VALUE) return NULL;
+	if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0)
 	{
-		fprintf(stdout, "File 'games.pgn' not found\n");
-		getchar();
-		exit(0);
+		HANDLE mapping = CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (mapping != NULL)
+		{
+			p = (const char*) MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+			if (p != NULL) *size = file_size.QuadPart;
+			CloseHandle(mapping);
+		}
 	}
-	double stat = 0.0, est = 0.0;
-	int cnt = 0;
-	while (true)
+	CloseHandle(file);
+#endif
+	return p;
+}
+
+void unmap_file(const char * p, int64_t size)
+{
+#ifdef UNIX
+	munmap((void*) p, size);
+#else
+	UnmapViewOfFile(p);
+#endif
+}
+
+// Start of the first game at or after p: games are separated by their "[FEN" tag
+const char * pgn_game_start(const char * p, const char * start, const char * end)
+{
+	for (; p < end; p++)
+		if ((p == start || p[-1] == '\n') && end - p >= 4 && !memcmp(p, "[FEN", 4)) return p;
+	return end;
+}
+
+// Replays the games in [start, end). Pass 0 calibrates the eval -> score ratio in Eval, pass 1 collects
+// the material statistics in Mat using the calibration.
+void pgn_stat_games(const char * start, const char * end, int iter, GStat * Eval, GStat * Mat)
+{
+	char * line = (char*) malloc(65536);
+	double result = 0.5;
+	int game = 0;
+	for (const char * p = start; p < end;)
 	{
-		fgets(mstring, 65536, fpgn);
-		if (feof(fpgn)) break;
-		if (strstr(mstring, "FEN")) get_board(mstring + 6);
-		double result;
-		if (strstr(mstring, "Result"))
+		const char * eol = (const char*) memchr(p, '\n', end - p);
+		if (eol == NULL) eol = end;
+		int length = Min(Convert(eol - p, int), 65535);
+		memcpy(line, p, length);
+		line[length] = 0;
+		p = eol + 1;
+		if (strstr(line, "FEN"))
 		{
-			if (strstr(mstring, "1-0")) result = 1.0;
-			else if (strstr(mstring, "0-1")) result = 0.0;
+			get_board(line + 6);
+			game = 1;
+			result = 0.5;
+		}
+		if (strstr(line, "Result"))
+		{
+			if (strstr(line, "1-0")) result = 1.0;
+			else if (strstr(line, "0-1")) result = 0.0;
 			else result = 0.5;
 		}
-		if (strchr(mstring, '[')) continue;
-		if (strlen(mstring) < 100) continue;
-		char * ptr = mstring;
+		if (strchr(line, '[')) continue;
+		if (strlen(line) < 100 || !game) continue;
+		game = 0;
+		char * ptr = line;
 		int eval[20], nc = 0;
 		memset(eval, 0, 20 * sizeof (int));
 		while (*ptr != 0)
@@ -2321,19 +2552,29 @@ loop:
 				if (!(Current->material & FlagUnusualMaterial) && Odd(iter))
 				{
 					int index = Current->material, conj_symm, conj_ld, conj_ld_symm;
+					double est = est_from_eval(eval[PosInRow - 1]);
 					conj_mat_index(index, &conj_symm, &conj_ld, &conj_ld_symm);
 					Mat[index].cnt++;
 					Mat[index].score += result;
-					Mat[index].est += est_from_eval(eval[PosInRow - 1]);
-					if (conj_symm >= 0) Mat[conj_symm].cnt++;
-					Mat[conj_symm].score += 1.0 - result;
-					Mat[conj_symm].est += 1.0 - est_from_eval(eval[PosInRow - 1]);
-					if (conj_ld >= 0) Mat[conj_ld].cnt++;
-					Mat[conj_ld].score += result;
-					Mat[conj_ld].est += est_from_eval(eval[PosInRow - 1]);
-					if (conj_ld_symm >= 0) Mat[conj_ld_symm].cnt++;
-					Mat[conj_ld_symm].score += 1.0 - result;
-					Mat[conj_ld_symm].est += 1.0 - est_from_eval(eval[PosInRow - 1]);
+					Mat[index].est += est;
+					if (conj_symm >= 0)
+					{
+						Mat[conj_symm].cnt++;
+						Mat[conj_symm].score += 1.0 - result;
+						Mat[conj_symm].est += 1.0 - est;
+					}
+					if (conj_ld >= 0)
+					{
+						Mat[conj_ld].cnt++;
+						Mat[conj_ld].score += result;
+						Mat[conj_ld].est += est;
+					}
+					if (conj_ld_symm >= 0)
+					{
+						Mat[conj_ld_symm].cnt++;
+						Mat[conj_ld_symm].score += 1.0 - result;
+						Mat[conj_ld_symm].est += 1.0 - est;
+					}
 				}
 			}
 			pv_string[0] = *ptr++;
@@ -2362,16 +2603,91 @@ loop:
 			while (*ptr == ' ') ptr++;
 			for (int i = 19; i >= 1; i--) eval[i] = eval[i - 1];
 			eval[0] = (int) (atof(ptr + 2) * 100.0);
-			ptr = strchr(ptr, '}') + 2;
+			if ((ptr = strchr(ptr, '}')) == NULL) break;
+			for (ptr++; *ptr == ' '; ptr++);
 		}
 	}
-	fclose(fpgn);
-	if (!iter)
+	free(line);
+}
+
+// Runs one pass over the mapped games with a private GStat accumulator per worker. On UNIX the workers are forked
+// processes (the replay uses the global board) writing into shared memory; the accumulators are summed at the end.
+void pgn_stat_pass(const char * pgn, int64_t size, int iter, int workers, GStat * Eval, GStat * Mat)
+{
+	int64_t slot_size = 64 + TotalMat;
+	GStat * Slots = NULL;
+	int i, j;
+#ifdef UNIX
+	pid_t Worker[MaxTunerWorkers];
+	if (workers > 1) Slots = (GStat*) mmap(NULL, workers * slot_size * sizeof (GStat), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if (Slots == MAP_FAILED) Slots = NULL;
+#endif
+	if (Slots == NULL)
 	{
-		for (int i = 0; i < 64; i++) fprintf(stdout, "ratio(eval x %.2lf) in (%.2lf, %.2lf), score = %.2lf\n", elo_eval_ratio, 50.0 + (double) i, 50.0 + (double) (i + 1), (Eval[i].score * 100.0) / Max(1.0, (double) Eval[i].cnt));
-		iter++;
-		goto loop;
+		pgn_stat_games(pgn, pgn + size, iter, Eval, Mat);
+		return;
+	}
+#ifdef UNIX
+	fflush(NULL);
+	for (i = 0; i < workers; i++)
+	{
+		const char * start = pgn_game_start(pgn + (size * i) / workers, pgn, pgn + size);
+		const char * end = pgn_game_start(pgn + (size * (i + 1)) / workers, pgn, pgn + size);
+		GStat * Slot = Slots + i * slot_size;
+		if (i == 0) start = pgn;
+		if ((Worker[i] = fork()) == 0)
+		{
+			// the slot holds increments only: the calibration read in pass 1 is the inherited Eval
+			pgn_stat_games(start, end, iter, Even(iter) ? Slot : Eval, Slot + 64);
+			_exit(0);
+		}
+		if (Worker[i] < 0) pgn_stat_games(start, end, iter, Even(iter) ? Slot : Eval, Slot + 64);
+	}
+	for (i = 0; i < workers; i++) if (Worker[i] > 0) waitpid(Worker[i], NULL, 0);
+	for (i = 0; i < workers; i++)
+	{
+		GStat * Slot = Slots + i * slot_size;
+		if (Even(iter)) for (j = 0; j < 64; j++)
+			{
+				Eval[j].cnt += Slot[j].cnt;
+				Eval[j].score += Slot[j].score;
+			}
+		else for (j = 0; j < TotalMat; j++)
+			{
+				Mat[j].cnt += Slot[64 + j].cnt;
+				Mat[j].score += Slot[64 + j].score;
+				Mat[j].est += Slot[64 + j].est;
+			}
+	}
+	munmap(Slots, workers * slot_size * sizeof (GStat));
+#endif
+}
+
+void pgn_stat(const char * file_name, int workers)
+{
+	GStat Eval[64];
+	for (int i = 0; i < 64; i++)
+	{
+		Eval[i].cnt = 0;
+		Eval[i].score = 1.0;
+	}
+	GStat * Mat = (GStat*) malloc(TotalMat * sizeof (GStat));
+	memset(Mat, 0, TotalMat * sizeof (GStat));
+	int64_t size = 0;
+	const char * pgn = map_file(file_name, &size);
+	if (pgn == NULL)
+	{
+		fprintf(stdout, "File '%s' not found\n", file_name);
+		free(Mat);
+		return;
 	}
+	workers = Max(1, Min(workers, MaxTunerWorkers));
+	fprintf(stdout, "%s: %.1lf MB, %d workers\n", file_name, (double) size / (1024.0 * 1024.0), workers);
+	pgn_stat_pass(pgn, size, 0, workers, Eval, Mat);
+	for (int i = 0; i < 64; i++) fprintf(stdout, "ratio(eval x %.2lf) in (%.2lf, %.2lf), score = %.2lf\n", elo_eval_ratio, 50.0 + (double) i, 50.0 + (double) (i + 1), (Eval[i].score * 100.0) / Max(1.0, (double) Eval[i].cnt));
+	pgn_stat_pass(pgn, size, 1, workers, Eval, Mat);
+	unmap_file(pgn, size);
+
 	FILE * fmat = fopen("material.txt", "w");
 	fprintf(fmat, "const int MaterialShift[MaterialShiftSize] = {\n");
 	int mat_cnt = 0;
@@ -2410,7 +2726,8 @@ loop:
 	}
 	fprintf(fmat, "}; %d\n", mat_cnt * 2);
 	fclose(fmat);
-	fprintf(stdout, "Press any key...\n");
+	free(Mat);
+	fprintf(stdout, "%d material shifts written to 'material.txt' (load with GULL_MATERIAL=material.txt)\n", mat_cnt);
 }
 #endif
 
@@ -3070,6 +3387,7 @@ void calc_material(int index)
 	}
 	if (score > 0) score = (score * mat[White]) / 32;
 	else score = (score * mat[Black]) / 32;
+	if (MaterialShift != NULL) score += MaterialShift[index];
 	Material[index].score = score;
 	for (me = 0; me < 2; me++)
 	{
@@ -3088,6 +3406,262 @@ void init_material()
 	for (int index = 0; index < TotalMat; index++) calc_material(index);
 }
 
+// Loads a "{index, score, ...}" list of material corrections in the format pgn_stat() writes
+int load_material_shift(const char * file_name)
+{
+	int index, score, cnt = 0;
+	FILE * f;
+	if (file_name == NULL || !file_name[0] || (f = fopen(file_name, "r")) == NULL) return 0;
+	while ((index = fgetc(f)) != EOF && index != '{');
+	if (MaterialShift == NULL) MaterialShift = (sint16*) malloc(TotalMat * sizeof (sint16));
+	memset(MaterialShift, 0, TotalMat * sizeof (sint16));
+	MaterialShiftKey = 0;
+	while (fscanf(f, " %d , %d ,", &index, &score) == 2)
+	{
+		if (index < 0 || index >= TotalMat) continue;
+		MaterialShift[index] = Max(-4096, Min(4096, score));
+		MaterialShiftKey = (MaterialShiftKey ^ ((Convert(index, uint64_t) << 16) | (uint16) MaterialShift[index])) * 0x100000001b3ULL;
+		cnt++;
+	}
+	fclose(f);
+	if (!cnt)
+	{
+		free(MaterialShift);
+		MaterialShift = NULL;
+	}
+	return cnt;
+}
+
+#ifndef TUNER
+// Kpk, Material and MagicAttacks only depend on compile-time constants, so they are cached on disk
+// between runs. The cache is keyed by the build stamp and table sizes and every section is checksummed;
+// on any mismatch the tables are recomputed and the file is rewritten.
+#define TableCacheVersion 2
+#define TableCacheFile "gull_tables.bin"
+const char * TableCache = NULL;
+
+typedef struct
+{
+	char tag[8], build[24];
+	int version, total_mat, material_size, magic_entries;
+	uint64_t material_shift, checksum[3];
+} GTableCacheHeader;
+
+void table_cache_header(GTableCacheHeader * header)
+{
+	memset(header, 0, sizeof (GTableCacheHeader));
+	memcpy(header->tag, "GULLTBL", 8);
+	strncpy(header->build, __DATE__ " " __TIME__, sizeof (header->build) - 1);
+	header->version = TableCacheVersion;
+	header->total_mat = TotalMat;
+	header->material_size = sizeof (GMaterial);
+	header->magic_entries = magic_size;
+	header->material_shift = MaterialShiftKey;
+}
+
+uint64_t table_checksum(const void * data, int64_t size)
+{
+	const uint64_t * p = (const uint64_t*) data;
+	uint64_t h = 0xcbf29ce484222325ULL;
+	for (int64_t i = 0; i < size / 8; i++) h = (h ^ p[i]) * 0x100000001b3ULL;
+	for (int64_t i = size & (~7); i < size; i++) h = (h ^ ((const uint8*) data)[i]) * 0x100000001b3ULL;
+	return h;
+}
+
+const char * table_cache_file()
+{
+	if (TableCache == NULL)
+	{
+		TableCache = getenv("GULL_TABLES");
+		if (TableCache == NULL) TableCache = TableCacheFile;
+	}
+	return TableCache;
+}
+
+int load_tables()
+{
+	GTableCacheHeader header, expected;
+	uint64_t kpk[2][64][64];
+	const char * name = table_cache_file();
+	FILE * f;
+	if (!name[0] || (f = fopen(name, "rb")) == NULL) return 0;
+	table_cache_header(&expected);
+	int ok = (fread(&header, sizeof (GTableCacheHeader), 1, f) == 1 && !memcmp(&header, &expected, offsetof(GTableCacheHeader, checksum))
+		&& fread(kpk, sizeof (kpk), 1, f) == 1 && table_checksum(kpk, sizeof (kpk)) == header.checksum[0]);
+	if (ok && parent)
+	{
+		// Material and MagicAttacks live in shared memory and are only filled in by the parent process
+		ok = (fread(Material, TotalMat * sizeof (GMaterial), 1, f) == 1 && table_checksum(Material, TotalMat * sizeof (GMaterial)) == header.checksum[1]
+			&& fread(MagicAttacks, magic_size * sizeof (uint64_t), 1, f) == 1 && table_checksum(MagicAttacks, magic_size * sizeof (uint64_t)) == header.checksum[2]);
+	}
+	fclose(f);
+	if (ok) memcpy(Kpk, kpk, sizeof (kpk));
+	return ok;
+}
+
+int save_tables()
+{
+	GTableCacheHeader header;
+	char temp[1024];
+	const char * name = table_cache_file();
+	FILE * f;
+	if (!name[0] || strlen(name) > 1000) return 0;
+	table_cache_header(&header);
+	header.checksum[0] = table_checksum(Kpk, sizeof (Kpk));
+	header.checksum[1] = table_checksum(Material, TotalMat * sizeof (GMaterial));
+	header.checksum[2] = table_checksum(MagicAttacks, magic_size * sizeof (uint64_t));
+	// written under a private name and renamed, so that concurrently started engines never see a partial file
+	sprintf(temp, "%s.%d", name, WinParId);
+	if ((f = fopen(temp, "wb")) == NULL) return 0;
+	int ok = (fwrite(&header, sizeof (GTableCacheHeader), 1, f) == 1 && fwrite(Kpk, sizeof (Kpk), 1, f) == 1
+		&& fwrite(Material, TotalMat * sizeof (GMaterial), 1, f) == 1 && fwrite(MagicAttacks, magic_size * sizeof (uint64_t), 1, f) == 1);
+	ok = (fclose(f) == 0 && ok);
+#ifndef UNIX
+	if (ok) remove(name);
+#endif
+	if (!ok || rename(temp, name))
+	{
+		remove(temp);
+		return 0;
+	}
+	return 1;
+}
+#endif
+
+#ifdef UNIX
+int64_t huge_page_size()
+{
+	char line[256];
+	int64_t size = 2048;
+	FILE * f = fopen("/proc/meminfo", "r");
+	if (f != NULL)
+	{
+		while (fgets(line, 256, f) != NULL)
+			if (sscanf(line, "Hugepagesize: %" SCNd64, &size) == 1) break;
+		fclose(f);
+	}
+	return size << 10;
+}
+
+// Whether madvise(MADV_HUGEPAGE) is honoured for shared (shmem) or private anonymous memory
+int transparent_huge_pages(int shared)
+{
+	char line[256];
+	int enabled = 0;
+	FILE * f = fopen(shared ? "/sys/kernel/mm/transparent_hugepage/shmem_enabled" : "/sys/kernel/mm/transparent_hugepage/enabled", "r");
+	if (f == NULL) return 0;
+	if (fgets(line, 256, f) != NULL)
+	{
+		char * p = strchr(line, '[');
+		enabled = (p != NULL && memcmp(p, "[never]", 7) && memcmp(p, "[deny]", 6));
+	}
+	fclose(f);
+	return enabled;
+}
+
+// Maps zeroed memory, backed by huge pages when LargePages is set: explicit hugetlb pages first,
+// then transparent huge pages, then normal pages. Shared mappings are inherited by the forked
+// children; the POSIX shared memory object of the normal-page path is unlinked right after it is mapped.
+void * map_pages(const char * name, int64_t * size, int shared, int64_t * page_size)
+{
+	void * p = MAP_FAILED;
+	int flags = (shared ? MAP_SHARED : MAP_PRIVATE) | MAP_ANONYMOUS;
+	*page_size = sysconf(_SC_PAGESIZE);
+#ifdef LARGE_PAGES
+	if (LargePages)
+	{
+		int64_t huge = huge_page_size(), rounded = ((*size + huge - 1) / huge) * huge;
+#ifdef MAP_HUGETLB
+		p = mmap(NULL, rounded, PROT_READ | PROT_WRITE, flags | MAP_HUGETLB, -1, 0);
+		if (p != MAP_FAILED)
+		{
+			*size = rounded;
+			*page_size = huge;
+			return p;
+		}
+#endif
+#ifdef MADV_HUGEPAGE
+		p = mmap(NULL, rounded, PROT_READ | PROT_WRITE, flags, -1, 0);
+		if (p != MAP_FAILED)
+		{
+			*size = rounded;
+			if (!madvise(p, rounded, MADV_HUGEPAGE) && transparent_huge_pages(shared)) *page_size = huge;
+			return p;
+		}
+#endif
+	}
+#endif
+	if (shared)
+	{
+		int fd = shm_open(name, O_CREAT | O_RDWR, 0600);
+		if (fd >= 0)
+		{
+			shm_unlink(name);
+			if (ftruncate(fd, *size) == 0) p = mmap(NULL, *size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+			close(fd);
+		}
+	}
+	if (p == MAP_FAILED) p = mmap(NULL, *size, PROT_READ | PROT_WRITE, flags, -1, 0);
+	if (p == MAP_FAILED)
+	{
+		fprintf(stdout, "Error %d\n", errno);
+		exit(1);
+	}
+	return p;
+}
+
+void report_pages()
+{
+	if (ReportPages & ReportSharedPages) fprintf(stdout, "info string Page size: hash %d kB, shared %d kB, pawn hash %d kB\n", Convert(HashPageSize >> 10, int),
+		Convert(SharedPageSize >> 10, int), Convert(PawnHashPageSize >> 10, int));
+	else if (ReportPages) fprintf(stdout, "info string Page size: hash %d kB, pawn hash %d kB\n", Convert(HashPageSize >> 10, int), Convert(PawnHashPageSize >> 10, int));
+	ReportPages = 0;
+}
+
+void init_pawn_hash()
+{
+#ifndef TUNER
+	int64_t size = pawn_hash_size * sizeof (GPawnEntry);
+	if (PawnHash != NULL) munmap(PawnHash, PawnHashMapSize);
+	PawnHash = (GPawnEntry*) map_pages(NULL, &size, 0, &PawnHashPageSize);
+	PawnHashMapSize = size;
+#endif
+}
+
+void init_hash()
+{
+#ifdef TUNER
+	return;
+#endif
+	char name[256];
+	int64_t size = (hash_size * sizeof (GEntry));
+	if (!parent) return;
+	sprintf(name, "/GULL_HASH_%d", WinParId);
+	if (Hash != NULL) munmap(Hash, HashMapSize);
+	Hash = (GEntry*) map_pages(name, &size, 1, &HashPageSize);
+	HashMapSize = size;
+	init_pawn_hash();
+	hash_mask = hash_size - 4;
+	ReportPages |= ReportHashPages; // the shared block keeps its pages
+}
+
+void init_shared()
+{
+#ifdef TUNER
+	return;
+#endif
+	char name[256];
+	int64_t size = SharedPVHashOffset + pv_hash_size * sizeof (GPVEntry);
+	if (!parent) return;
+	sprintf(name, "/GULL_SHARED_%d", WinParId);
+	if (Smpi != NULL) munmap(Smpi, SharedMapSize);
+	Smpi = (GSMPI*) map_pages(name, &size, 1, &SharedPageSize);
+	SharedMapSize = size;
+	Material = (GMaterial*) (((char*) Smpi) + SharedMaterialOffset);
+	MagicAttacks = (uint64_t*) (((char*) Smpi) + SharedMagicOffset);
+	PVHash = (GPVEntry*) (((char*) Smpi) + SharedPVHashOffset);
+}
+#else
 void init_hash()
 {
 #ifdef TUNER
@@ -3170,21 +3744,34 @@ void init_shared()
 	PVHash = (GPVEntry*) (((char*) Smpi) + SharedPVHashOffset);
 	if (parent) memset(PVHash, 0, pv_hash_size * sizeof (GPVEntry));
 }
+#endif
 
 void init()
 {
 	init_shared();
 	init_misc();
-	if (parent) init_magic();
+	load_material_shift(getenv("GULL_MATERIAL"));
+#ifndef TUNER
+	int cached = load_tables();
+#else
+	int cached = 0;
+#endif
+	if (parent && !cached) init_magic();
 	for (int i = 0; i < 64; i++)
 	{
 		BOffsetPointer[i] = MagicAttacks + BOffset[i];
 		ROffsetPointer[i] = MagicAttacks + ROffset[i];
 	}
-	gen_kpk();
+	if (!cached) gen_kpk();
 	init_pst();
 	init_eval();
-	if (parent) init_material();
+	if (parent && !cached)
+	{
+		init_material();
+#ifndef TUNER
+		save_tables();
+#endif
+	}
 #ifdef EXPLAIN_EVAL
 	memset(GullCppFile, 0, 16384 * 256);
 	FILE * fcpp;
@@ -6297,7 +6884,11 @@ start:
 	if (Smpi->searching & Bit(Id)) return;
 	if (!(Smpi->searching & 1))
 	{
+#ifdef UNIX
+		usleep(1000);
+#else
 		Sleep(1);
+#endif
 		return;
 	}
 	while ((Smpi->searching & 1) && !Smpi->active_sp) _mm_pause();
@@ -6417,7 +7008,9 @@ template <bool me, bool exclusion> int search(int beta, int depth, int flags)
 #ifndef TUNER
 	if (nodes > check_node_smp + 0x10)
 	{
-#ifndef W32_BUILD
+#if defined(UNIX)
+		__atomic_fetch_add(&Smpi->nodes, (long long) (nodes)-(long long) (check_node_smp), __ATOMIC_RELAXED);
+#elif !defined(W32_BUILD)
 		InterlockedAdd64(&Smpi->nodes, (long long) (nodes)-(long long) (check_node_smp));
 #else
 		Smpi->nodes += (long long) (nodes)-(long long) (check_node_smp);
@@ -7559,10 +8152,10 @@ void send_pv(int depth, int alpha, int beta, int score)
 	if (nps) nps = (snodes * 1000) / nps;
 	if (score < beta)
 	{
-		if (score <= alpha) fprintf(stdout, "info depth %d seldepth %d score %s%d upperbound nodes %I64d nps %I64d pv %s\n", depth, sel_depth, score_string, (mate ? mate_score : score), snodes, nps, pv_string);
-		else fprintf(stdout, "info depth %d seldepth %d score %s%d nodes %I64d nps %I64d pv %s\n", depth, sel_depth, score_string, (mate ? mate_score : score), snodes, nps, pv_string);
+		if (score <= alpha) fprintf(stdout, "info depth %d seldepth %d score %s%d upperbound nodes %" I64 " nps %" I64 " pv %s\n", depth, sel_depth, score_string, (mate ? mate_score : score), snodes, nps, pv_string);
+		else fprintf(stdout, "info depth %d seldepth %d score %s%d nodes %" I64 " nps %" I64 " pv %s\n", depth, sel_depth, score_string, (mate ? mate_score : score), snodes, nps, pv_string);
 	}
-	else fprintf(stdout, "info depth %d seldepth %d score %s%d lowerbound nodes %I64d nps %I64d pv %s\n", depth, sel_depth, score_string, (mate ? mate_score : score), snodes, nps, pv_string);
+	else fprintf(stdout, "info depth %d seldepth %d score %s%d lowerbound nodes %" I64 " nps %" I64 " pv %s\n", depth, sel_depth, score_string, (mate ? mate_score : score), snodes, nps, pv_string);
 	fflush(stdout);
 }
 
@@ -7635,7 +8228,7 @@ void send_multipv(int depth, int curr_number)
 		snodes = nodes;
 #endif
 		if (nps) nps = (snodes * 1000) / nps;
-		fprintf(stdout, "info multipv %d depth %d score %s%d nodes %I64d nps %I64d pv %s\n", j + 1, (j <= curr_number ? depth : depth - 1), score_string, score, snodes, nps, pv_string);
+		fprintf(stdout, "info multipv %d depth %d score %s%d nodes %" I64 " nps %" I64 " pv %s\n", j + 1, (j <= curr_number ? depth : depth - 1), score_string, score, snodes, nps, pv_string);
 		fflush(stdout);
 	}
 }
@@ -7654,7 +8247,7 @@ void send_best_move()
 #else
 	snodes = nodes;
 #endif
-	fprintf(stdout, "info nodes %I64d score cp %d\n", snodes, best_score);
+	fprintf(stdout, "info nodes %" I64 " score cp %d\n", snodes, best_score);
 	if (!best_move) return;
 	Current = Data;
 	evaluate();
@@ -7874,7 +8467,13 @@ int64_t get_time()
 	}
 #endif
 #endif
+#ifdef UNIX
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return Convert(t.tv_sec, int64_t) * 1000 + t.tv_nsec / 1000000;
+#else
 	return GetTickCount();
+#endif
 }
 
 int time_to_stop(GSearchInfo * SI, int time, int searching)
@@ -8134,6 +8733,9 @@ void uci()
 		fprintf(stdout, "option name Large memory pages type check default true\n");
 #endif
 		fprintf(stdout, "uciok\n");
+#ifdef UNIX
+		ReportPages |= ReportHashPages | ReportSharedPages;
+#endif
 		if (F(Searching)) init_search(1);
 	}
 	else if (!strcmp(mstring, "ucinewgame"))
@@ -8143,6 +8745,9 @@ void uci()
 	}
 	else if (!strcmp(mstring, "isready"))
 	{
+#ifdef UNIX
+		report_pages();
+#endif
 		fprintf(stdout, "readyok\n");
 		fflush(stdout);
 	}
@@ -8263,8 +8868,13 @@ void uci()
 	{
 		for (i = 1; i < PrN; i++)
 		{
+#ifdef UNIX
+			kill(ChildPr[i], SIGKILL);
+			waitpid(ChildPr[i], NULL, 0);
+#else
 			TerminateProcess(ChildPr[i], 0);
 			CloseHandle(ChildPr[i]);
+#endif
 		}
 		exit(0);
 	}
@@ -8276,6 +8886,28 @@ void uci()
 	}
 }
 
+#ifdef UNIX
+pid_t CreateChildProcess(int child_id)
+{
+	fflush(NULL);
+	pid_t pid = fork();
+	if (pid == 0)
+	{
+#ifdef __linux__
+		prctl(PR_SET_PDEATHSIG, SIGKILL);
+		if (getppid() != WinParId) _exit(0);
+#endif
+		if (freopen("/dev/null", "w", stdout) == NULL) _exit(1);
+		init_pawn_hash();
+		child = 1;
+		parent = 0;
+		Id = child_id;
+		while (true) check_state();
+	}
+	if (pid < 0) fprintf(stdout, "Error %d\n", errno);
+	return pid;
+}
+#else
 HANDLE CreateChildProcess(int child_id)
 {
 	char name[1024];
@@ -8308,13 +8940,16 @@ HANDLE CreateChildProcess(int child_id)
 		return NULL;
 	}
 }
+#endif
 
 int main(int argc, char *argv[])
 {
+#ifndef UNIX
 	DWORD p;
-	int i, HT = 0;
 	SYSTEM_INFO sysinfo;
-	bool bench = false;
+#endif
+	int i, HT = 0;
+	bool bench = false, tables = false;
 
 	if (argc >= 2)
 	{
@@ -8329,12 +8964,27 @@ int main(int argc, char *argv[])
 		{
 			bench = true;
 		}
+#ifndef TUNER
+		else if (!strcmp(argv[1], "tables"))
+		{
+			tables = true;
+			if (argc >= 3) TableCache = argv[2];
+		}
+#endif
 	}
 
 	HardwarePopCnt = __builtin_cpu_supports("popcnt");
 
 	if (parent)
 	{
+#ifdef UNIX
+		WinParId = getpid();
+		if (MaxPrN > 1)
+		{
+			CPUs = Max(1, Convert(sysconf(_SC_NPROCESSORS_ONLN), int));
+			PrN = Min(CPUs, MaxPrN);
+		}
+#else
 		if (GetProcAddress(GetModuleHandle(TEXT("kernel32")), "GetLogicalProcessorInformation") != NULL)
 		{
 			SYSTEM_LOGICAL_PROCESSOR_INFORMATION syslogprocinfo[1];
@@ -8357,12 +9007,24 @@ int main(int argc, char *argv[])
 			PrN = Min(CPUs, MaxPrN);
 			if (HT) PrN = Max(1, Min(PrN, CPUs / 2));
 		}
+#endif
 	}
 
 #ifdef CPU_TIMING
 	SetPriorityClass(GetCurrentProcess(), IDLE_PRIORITY_CLASS);
 #endif
 
+#ifndef TUNER
+	if (tables)
+	{
+		// "gull tables [file]" regenerates the precomputed table cache, e.g. as a build step
+		if (!table_cache_file()[0]) return 1;
+		remove(table_cache_file());
+		init();
+		return (load_tables() ? 0 : 1);
+	}
+#endif
+
 	init();
 
 	setbuf(stdout, NULL);
@@ -8383,12 +9045,17 @@ reset_jump:
 	{
 		if (setjmp(ResetJump))
 		{
+#ifdef UNIX
+			for (i = 1; i < PrN; i++) kill(ChildPr[i], SIGKILL);
+			for (i = 1; i < PrN; i++) waitpid(ChildPr[i], NULL, 0);
+#else
 			for (i = 1; i < PrN; i++) TerminateProcess(ChildPr[i], 0);
 			for (i = 1; i < PrN; i++)
 			{
 				WaitForSingleObject(ChildPr[i], INFINITE);
 				CloseHandle(ChildPr[i]);
 			}
+#endif
 			Smpi->searching = Smpi->active_sp = Smpi->stop = 0;
 			for (i = 0; i < MaxSplitPoints; i++) Smpi->Sp->active = Smpi->Sp->claimed = 0;
 
@@ -8430,14 +9097,25 @@ reset_jump:
 		if (Client || Server) Local = 0;
 	}
 	fprintf(stdout, Client ? "Client\n" : (Server ? "Server\n" : "Local\n"));
+	// "gull pgnstat <games.pgn> [workers]" recomputes the material corrections from recorded games
+	bool pgnstat = (argc >= 3 && !strcmp(argv[1], "pgnstat"));
 
+#ifdef UNIX
+	srand(time(NULL) + 123 * getpid() + clock());
+	seed = (uint64_t) (time(NULL) + 345 * getpid() + clock());
+#else
 	uint64_t ctime;
 	QueryProcessCycleTime(GetCurrentProcess(), &ctime);
 	srand(time(NULL) + 123 * GetProcessId(GetCurrentProcess()) + ctime);
 	QueryProcessCycleTime(GetCurrentProcess(), &ctime);
 	seed = (uint64_t) (time(NULL) + 345 * GetProcessId(GetCurrentProcess()) + ctime);
+#endif
 	init_openings();
 	init_variables();
+#ifdef UNIX
+	// "gull local [workers]" plays the tuning games in a local pool, by default one worker per CPU
+	if (Local && !pgnstat) init_tuner_pool((argc >= 3 && !strcmp(argv[1], "local")) ? Max(1, atoi(argv[2])) : Max(1, Convert(sysconf(_SC_NPROCESSORS_ONLN), int)));
+#endif
 
 	if (Client)
 	{
@@ -8457,7 +9135,15 @@ reset_jump:
 
 	save_list(Base);
 
-	//pgn_stat();
+	if (pgnstat)
+	{
+#ifdef UNIX
+		pgn_stat(argv[2], argc >= 4 ? atoi(argv[3]) : Convert(sysconf(_SC_NPROCESSORS_ONLN), int));
+#else
+		pgn_stat(argv[2], 1);
+#endif
+		return 0;
+	}
 #ifdef RECORD_GAMES
 	match_los(Base, Base, 4 * 64 * 1024, 512, 7, 0.0, 0.0, 0.0, 0.0, MatchInfo, 1);
 #endif
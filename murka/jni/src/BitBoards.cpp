@@ -7,20 +7,8 @@ using namespace std;
 #include "IO.h"
 
 // �������� ��� �����
-BitBoard WhitePieces, BlackPieces;
-BitBoard BitBoards[13];
-BitBoard &WhitePawns   = BitBoards[ptWhitePawn];
-BitBoard &WhiteKnights = BitBoards[ptWhiteKnight];
-BitBoard &WhiteBishops = BitBoards[ptWhiteBishop];
-BitBoard &WhiteRooks   = BitBoards[ptWhiteRook];
-BitBoard &WhiteQueens  = BitBoards[ptWhiteQueen];
-BitBoard &WhiteKing    = BitBoards[ptWhiteKing];
-BitBoard &BlackPawns   = BitBoards[ptBlackPawn];
-BitBoard &BlackKnights = BitBoards[ptBlackKnight];
-BitBoard &BlackBishops = BitBoards[ptBlackBishop];
-BitBoard &BlackRooks   = BitBoards[ptBlackRook];
-BitBoard &BlackQueens  = BitBoards[ptBlackQueen];
-BitBoard &BlackKing    = BitBoards[ptBlackKing];
+TLS BitBoard WhitePieces, BlackPieces;
+TLS BitBoard BitBoards[13];
 
 // ����
 BitBoard KnightMoves[64], KingMoves[64];
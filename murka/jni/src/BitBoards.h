@@ -51,14 +51,20 @@ const BitBoard Rank7 = RankMask[1];
 const BitBoard Rank8 = RankMask[0];
 
 // ��������
-extern BitBoard WhitePieces, BlackPieces;
-extern BitBoard BitBoards[13];
-extern BitBoard &WhitePawns,   &BlackPawns;
-extern BitBoard &WhiteKnights, &BlackKnights;
-extern BitBoard &WhiteBishops, &BlackBishops;
-extern BitBoard &WhiteRooks,   &BlackRooks;
-extern BitBoard &WhiteQueens,  &BlackQueens;
-extern BitBoard &WhiteKing,    &BlackKing;
+extern TLS BitBoard WhitePieces, BlackPieces;
+extern TLS BitBoard BitBoards[13];
+#define WhitePawns   BitBoards[ptWhitePawn]
+#define WhiteKnights BitBoards[ptWhiteKnight]
+#define WhiteBishops BitBoards[ptWhiteBishop]
+#define WhiteRooks   BitBoards[ptWhiteRook]
+#define WhiteQueens  BitBoards[ptWhiteQueen]
+#define WhiteKing    BitBoards[ptWhiteKing]
+#define BlackPawns   BitBoards[ptBlackPawn]
+#define BlackKnights BitBoards[ptBlackKnight]
+#define BlackBishops BitBoards[ptBlackBishop]
+#define BlackRooks   BitBoards[ptBlackRook]
+#define BlackQueens  BitBoards[ptBlackQueen]
+#define BlackKing    BitBoards[ptBlackKing]
 
 // �����
 extern BitBoard WPawnAtk[64], BPawnAtk[64];
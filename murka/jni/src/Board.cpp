@@ -13,10 +13,10 @@ using namespace std;
 #include "Eval.h"
 
 // ���������� ����� ������ ����������� �� ������ ����
-uint8 Piece[64];
+TLS uint8 Piece[64];
 
 // ����������� ���� �����
-bool WTM;
+TLS bool WTM;
 
 // ��������� ����������� �����
 char PieceLetter[] = {'.', 'P', 'N', 'B', 'R', 'Q', 'K', 'p', 'n', 'b', 'r', 'q', 'k'};
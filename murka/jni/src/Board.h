@@ -3,8 +3,8 @@
 
 #include "BitBoards.h"
 
-extern bool WTM;
-extern uint8 Piece[64];
+extern TLS bool WTM;
+extern TLS uint8 Piece[64];
 extern char PieceLetter[];
 
 // 
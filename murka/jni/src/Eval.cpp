@@ -305,7 +305,7 @@ void InitEval()
 	}
 }
 
-PawnHashEntry *PawnHash = new PawnHashEntry[PawnHashMask + 1];
+TLS PawnHashEntry PawnHash[PawnHashMask + 1];
 
 //       
 bool TestPST(__int32 op, __int32 eg)
@@ -3,6 +3,11 @@
 #include <stdlib.h>
 #include <iostream>
 using namespace std;
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
 
 #include "Types.h"
 #include "Board.h"
@@ -12,13 +17,17 @@ using namespace std;
 #include "Protocols.h"
 
 #ifdef AUTOTUNING
-uint32 HashMask = 0xffff;
+uint32 HashMask = 0x3fff;
 #else
-uint32 HashMask = 0x7fffff;
+uint32 HashMask = 0x1fffff;
 #endif
 
 //  
 TransEntry *Trans;
+//    
+uint64 TransBytes;
+//   
+uint8 TransAge;
 
 // -
 uint64 HashKeys[13][64]; //   
@@ -75,31 +84,104 @@ void CalcHashKey()
 	if (WTM) NI->HashKey ^= HashKeyWTM;
 }
 
-void SetTransSize(uint16 size)
+//       :
+//     ,
+//       
+TransEntry *AllocTrans(uint64 bytes)
+{
+#ifdef _WIN32
+	return (TransEntry *)VirtualAlloc(0, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#else
+	void *p = mmap(0, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	return p == MAP_FAILED? 0 : (TransEntry *)p;
+#endif
+}
+
+void FreeTrans()
 {
-	if (size > 1024) size = 1024;
-	HashMask = 1;
-	while (HashMask * sizeof(TransEntry) < size * 1024 * 1024)
+	if (!Trans) return;
+#ifdef _WIN32
+	VirtualFree(Trans, 0, MEM_RELEASE);
+#else
+	munmap(Trans, TransBytes);
+#endif
+	Trans = 0;
+}
+
+//     
+void SetTransSize(uint32 size)
+{
+	if (size < 1) size = 1;
+	if (size > MaxTransSize) size = MaxTransSize;
+
+	//   -  
+	uint64 buckets = 1;
+	while (buckets * 2 * TransWays * sizeof(TransEntry) <= (uint64)size * 1024 * 1024) buckets <<= 1;
+
+	FreeTrans();
+	//    ,    
+	for (;;)
 	{
-		HashMask <<= 1;
-		HashMask |= 1;
+		TransBytes = buckets * TransWays * sizeof(TransEntry);
+		Trans = AllocTrans(TransBytes);
+		if (Trans || buckets == 1) break;
+		buckets >>= 1;
 	}
-	if (HashMask * sizeof(TransEntry) > size * 1024 * 1024) HashMask >>= 1;
-	if (Trans) delete[] Trans;
-	Trans = new TransEntry[HashMask + 1];
-	memset(Trans, 0, sizeof(TransEntry) * (HashMask + 1));
+	HashMask = buckets - 1;
+}
+
+//    
+void TransNewSearch()
+{
+	TransAge += tfAgeStep;
+}
+
+//    :   
+inline int TransValue(TransEntry *he)
+{
+	return he->Depth - (uint8)(TransAge - (he->Flags & tfAgeMask));
 }
 
 //       
 void TransStore(__int16 score, uint8 depth, uint8 ply, uint8 flags, Move m)
 {
-	TransEntry *he = Trans + (NI->HashKey & HashMask);
-	he->Key = NI->HashKey;
-	he->Move = m;
-	he->Flags = flags;
+	uint64 key = NI->HashKey;
+	TransEntry *he = TransBucket(key);
+
+	//    ,     
+	TransEntry *re = he;
+	for (uint8 i = 0; i < TransWays; i++, he++)
+	{
+		if ((he->Key ^ he->Data) == key)
+		{
+			re = he;
+			break;
+		}
+		if (TransValue(he) < TransValue(re)) re = he;
+	}
+
+	TransEntry te;
+	te.Move = m;
+	te.Flags = flags | TransAge;
 	//   
-	if (score > 32000) he->Score = score + ply;
-	else if (score < -32000) he->Score = score - ply;
-	else he->Score = score;
-	he->Depth = depth;
+	if (score > 32000) te.Score = score + ply;
+	else if (score < -32000) te.Score = score - ply;
+	else te.Score = score;
+	te.Depth = depth;
+
+	re->Key = key ^ te.Data;
+	re->Data = te.Data;
+}
+
+//       
+uint32 TransFull()
+{
+	uint32 cnt = 0;
+	uint32 n = 1000;
+	if (n > (HashMask + 1) * TransWays) n = (HashMask + 1) * TransWays;
+	for (uint32 i = 0; i < n; i++)
+	{
+		if (Trans[i].Depth && (Trans[i].Flags & tfAgeMask) == TransAge) cnt++;
+	}
+	return cnt * 1000 / n;
 }
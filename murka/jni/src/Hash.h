@@ -4,14 +4,22 @@
 #include "Types.h"
 #include "Moves.h"
 
-void SetTransSize(uint16 size);
+void SetTransSize(uint32 size);
 void InitHashKeys();
 void CalcHashKey();
 void TransStore(__int16 score, uint8 depth, uint8 ply, uint8 flags, Move m);
+void TransNewSearch();
+uint32 TransFull();
 
 const uint8 tfLowerBound = 1;
 const uint8 tfExact      = 2;
 const uint8 tfUpperBound = 4;
+//    -  ( ),    
+const uint8 tfAgeStep    = 8;
+const uint8 tfAgeMask    = 0xf8;
+
+//      
+const uint32 MaxTransSize = sizeof(void *) == 8? 65536 : 1024;
 
 struct PawnHashEntry
 {
@@ -29,21 +37,34 @@ struct PawnHashEntry
 };
 
 const uint32 PawnHashMask = 0x7ff;
-extern PawnHashEntry *PawnHash;
+extern TLS PawnHashEntry PawnHash[PawnHashMask + 1];
 
+//   ,   xor  ,
+//  ,      ,
+//     
 struct TransEntry
 {
 	uint64 Key;
-	Move Move;
-	__int16 Score;
-	uint8 Flags;
-	uint8 Depth;
+	union
+	{
+		struct
+		{
+			Move Move;
+			__int16 Score;
+			uint8 Flags;
+			uint8 Depth;
+		};
+		uint64 Data;
+	};
 
 #ifdef TEST
 	uint64 Nodes;
 #endif
 };
 
+//     (4   16  -   )
+const uint8 TransWays = 4;
+
 extern uint32 HashMask;
 extern TransEntry *Trans;
 extern uint64 HashKeys[13][64];
@@ -51,4 +72,26 @@ extern uint64 HashKeysEP[64];
 extern uint64 HashKeysCR[16];
 extern uint64 HashKeyWTM;
 
+//     
+inline TransEntry *TransBucket(uint64 key)
+{
+	return Trans + (key & HashMask) * TransWays;
+}
+
+//     ,     te
+inline bool TransProbe(uint64 key, TransEntry &te)
+{
+	TransEntry *he = TransBucket(key);
+	for (uint8 i = 0; i < TransWays; i++, he++)
+	{
+		uint64 data = he->Data;
+		if ((he->Key ^ data) == key)
+		{
+			te.Data = data;
+			return true;
+		}
+	}
+	return false;
+}
+
 #endif
@@ -8,6 +8,7 @@ using namespace std;
 #include "Search.h"
 #include "TimeManager.h"
 #include "Protocols.h"
+#include "Hash.h"
 
 //  
 void PrintSquare(uint8 sq)
@@ -72,19 +73,20 @@ void PrintBestLine(uint8 depth, __int16 score, Move m)
 	char str[256];
 	char sm[8];
 	MoveToStr(m, sm);
+	uint64 nodes = TotalNodes();
 
 	if (UciMode)
 	{
 		uint32 t = TimeElapsed();
-		uint32 nps = t? Nodes * 1000 / t : 0;
+		uint32 nps = t? nodes * 1000 / t : 0;
 		//  
-		if (abs(score) > 32000) sprintf(str, "info depth %u score mate %d time %u nodes %I64u nps %u pv %s\n", depth, (MATE + (score > 0? -score + 1 : score)) / 2, t, Nodes, nps, sm);
+		if (abs(score) > 32000) sprintf(str, "info depth %u score mate %d time %u nodes %I64u nps %u hashfull %u pv %s\n", depth, (MATE + (score > 0? -score + 1 : score)) / 2, t, nodes, nps, TransFull(), sm);
 		//    
-		else sprintf(str, "info depth %u score cp %d time %u nodes %I64u nps %u pv %s\n", depth, score, t, Nodes, nps, sm);
+		else sprintf(str, "info depth %u score cp %d time %u nodes %I64u nps %u hashfull %u pv %s\n", depth, score, t, nodes, nps, TransFull(), sm);
 	}
 	if (XBoardMode)
 	{
-		sprintf(str, "%u %d %u %I64u %s\n", depth, score, TimeElapsed() / 10, Nodes, sm);
+		sprintf(str, "%u %d %u %I64u %s\n", depth, score, TimeElapsed() / 10, nodes, sm);
 	}
 	cout << str;
 	cout.flush();
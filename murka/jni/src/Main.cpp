@@ -17,11 +17,12 @@ void __cdecl main(int argc, char **argv)
 	cout << "\nCopyright (C) 2010-2013 Igor Korshunov" << endl;
 
 	uint8 i = 1;
-	uint16 trans_size = 128;
+	uint32 trans_size = 128;
 	while (i < argc)
 	{
 		if (!strcmp(argv[i], "-l")) Log = true;
 		else if (!strcmp(argv[i], "-h")) trans_size = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-t")) SetThreads(atoi(argv[++i]));
 		i++;
 	}
 
@@ -161,7 +161,8 @@ void UCI()
 
 	cout << "id name " MY_NAME " UCI\n";
 	cout << "id author Igor Korshunov\n";
-	cout << "option name Hash type spin default 128 min 1 max 1024\n";
+	cout << "option name Hash type spin default 128 min 1 max " << MaxTransSize << "\n";
+	cout << "option name Threads type spin default 1 min 1 max " << int(MaxThreads) << "\n";
 	cout << "uciok\n";
 	cout.flush();
 	OpenLog("_uci");
@@ -198,10 +199,17 @@ void UCI()
 			{
 				p = strtok(0, " ");
 				p = strtok(0, " ");
-				uint16 size = atoi(p);
+				uint32 size = atoi(p);
 				SetTransSize(size);
 				cout << "info string hash " << size << endl;
 			}
+			else if (!stricmp(p, "Threads"))
+			{
+				p = strtok(0, " ");
+				p = strtok(0, " ");
+				SetThreads(atoi(p));
+				cout << "info string threads " << int(Threads) << endl;
+			}
 		}
 		else if (!strcmp(p, "ucinewgame"))
 		{
@@ -391,6 +399,7 @@ void XBoard()
 			cout << "feature playother=1\n";
 			cout << "feature draw=0\n";
 			cout << "feature analyze=1\n";
+			cout << "feature smp=1\n";
 			cout << "feature variants=\"normal\"\n";
 			cout << "feature name=0\n";
 			cout << "feature done=1\n";
@@ -495,6 +504,11 @@ void XBoard()
 			Flog << "pong " << p << endl;
 			Flog.flush();
 		}
+		else if (!strcmp(p, "cores"))
+		{
+			p = strtok(0, " ");
+			SetThreads(atoi(p));
+		}
 		else if (!strcmp(p, "analyze"))
 		{
 			AnalyzeMode = true;
@@ -1,4 +1,6 @@
 #include <iostream>
+#include <thread>
+#include <atomic>
 using namespace std;
 #include <assert.h>
 
@@ -14,37 +16,48 @@ using namespace std;
 #define ply (NI - RootNI)
 extern int PieceValueEg[];
 
-Move BestMove;
+TLS Move BestMove;
 
 //      
 //      
 const uint64 NodesCheckIntervalMin = 10000;
 const uint64 NodesCheckIntervalMax = 1000000;
 //    
-uint64 CheckNodes;
+TLS uint64 CheckNodes;
 //   
-uint64 Nodes;
+TLS uint64 Nodes;
 //    
 uint64 NodesLimit = 0;
 
 //    
-NodeInfo NodesInfo[1024];
+TLS NodeInfo NodesInfo[1024];
 //    
-NodeInfo *NI = NodesInfo;
+TLS NodeInfo *NI;
 //    
-NodeInfo *RootNI;
+TLS NodeInfo *RootNI;
 
 //   
 uint8 DepthLimit = 99;
 
 //   
-bool SearchAborted;
+TLS bool SearchAborted;
 
 // 
-uint32 History[13][64];
+TLS uint32 History[13][64];
 
 Move NullMove = {0};
 
+//   
+uint8 Threads = 1;
+//    (0 - )
+TLS uint8 ThreadId;
+//     
+atomic<bool> StopThreads;
+//  ,   
+atomic<uint64> ThreadNodes[MaxThreads];
+//  
+thread Helpers[MaxThreads];
+
 //    
 inline bool Repetition()
 {
@@ -70,10 +83,20 @@ inline bool Repetition()
 //      
 inline bool SearchNeedAbort()
 {
-	
+	//       
+	if (ThreadId)
+	{
+		if (Nodes >= CheckNodes)
+		{
+			ThreadNodes[ThreadId].store(Nodes, memory_order_relaxed);
+			CheckNodes = Nodes + NodesCheckIntervalMin;
+		}
+		return StopThreads;
+	}
+
 	if (NodesLimit)
 	{
-		if (Nodes < NodesLimit) return false;
+		if (TotalNodes() < NodesLimit) return false;
 		return true;
 	}
 
@@ -367,17 +390,17 @@ __int16 SearchCut(__int16 beta, uint8 depth)
 
 	//  
 	Move tm = NullMove;
-	TransEntry *he = Trans + (NI->HashKey & HashMask);
-	if (he->Key == NI->HashKey)
+	TransEntry he;
+	if (TransProbe(NI->HashKey, he))
 	{
-		tm = he->Move;
-		if (he->Depth >= depth)
+		tm = he.Move;
+		if (he.Depth >= depth)
 		{
-			__int16 ts = he->Score;
+			__int16 ts = he.Score;
 			if (ts > 32000) ts -= ply;
 			else if (ts < -32000) ts += ply;
-			if (he->Flags & tfExact) return ts;
-			if (he->Flags & tfUpperBound)
+			if (he.Flags & tfExact) return ts;
+			if (he.Flags & tfUpperBound)
 			{
 				if (ts < beta) return ts;
 			}
@@ -538,17 +561,17 @@ __int16 SearchCheck(__int16 beta, uint8 depth)
 
 	//  
 	Move tm = NullMove;
-	TransEntry *he = Trans + (NI->HashKey & HashMask);
-	if (he->Key == NI->HashKey)
+	TransEntry he;
+	if (TransProbe(NI->HashKey, he))
 	{
-		tm = he->Move;
-		if (he->Depth >= depth)
+		tm = he.Move;
+		if (he.Depth >= depth)
 		{
-			__int16 ts = he->Score;
+			__int16 ts = he.Score;
 			if (ts > 32000) ts -= ply;
 			else if (ts < -32000) ts += ply;
-			if (he->Flags & tfExact) return ts;
-			if (he->Flags & tfUpperBound)
+			if (he.Flags & tfExact) return ts;
+			if (he.Flags & tfUpperBound)
 			{
 				if (ts < beta) return ts;
 			}
@@ -619,8 +642,8 @@ __int16 SearchPV(__int16 alpha, __int16 beta, uint8 depth)
 
 	//  
 	Move tm = NullMove;
-	TransEntry *he = Trans + (NI->HashKey & HashMask);
-	if (he->Key == NI->HashKey)	tm = he->Move;
+	TransEntry he;
+	if (TransProbe(NI->HashKey, he)) tm = he.Move;
 	else tm = NullMove;
 
 	// IID
@@ -720,8 +743,8 @@ __int16 SearchPV(__int16 alpha, __int16 beta, uint8 depth)
 
 int LastScore;
 
-//    
-Move RootSearch()
+//       
+Move MainSearch()
 {
 	if (DepthLimit < 99) TimeLimitHard = TimeLimitSoft = 0;
 	else StartTimer();
@@ -751,8 +774,8 @@ Move RootSearch()
 	ml.cm = ml.List;
 
 	Move tm = NullMove;
-	TransEntry *he = Trans + (NI->HashKey & HashMask);
-	if (he->Key == NI->HashKey)	tm = he->Move;
+	TransEntry he;
+	if (TransProbe(NI->HashKey, he)) tm = he.Move;
 	
 	NI[0].Killer1 = NI[2].Killer1;
 	NI[0].Killer2 = NI[2].Killer2;
@@ -870,3 +893,114 @@ Move RootSearch()
 
 	return ml.List[0].move;
 }
+
+//   ,      
+struct RootPosition
+{
+	uint8 piece[64];
+	BitBoard bb[13];
+	BitBoard white, black;
+	bool wtm;
+	//        
+	uint16 cnt;
+	NodeInfo ni[1024];
+} Root;
+
+//    
+void SaveRoot()
+{
+	memcpy(Root.piece, Piece, sizeof(Root.piece));
+	memcpy(Root.bb, BitBoards, sizeof(Root.bb));
+	Root.white = WhitePieces;
+	Root.black = BlackPieces;
+	Root.wtm = WTM;
+	Root.cnt = NI - NodesInfo + 1;
+	memcpy(Root.ni, NodesInfo, Root.cnt * sizeof(NodeInfo));
+}
+
+//       
+void LoadRoot()
+{
+	memcpy(Piece, Root.piece, sizeof(Root.piece));
+	memcpy(BitBoards, Root.bb, sizeof(Root.bb));
+	WhitePieces = Root.white;
+	BlackPieces = Root.black;
+	WTM = Root.wtm;
+	memcpy(NodesInfo, Root.ni, Root.cnt * sizeof(NodeInfo));
+	NI = NodesInfo + Root.cnt - 1;
+}
+
+//     (Lazy SMP):
+//      
+//     
+void HelperSearch(uint8 id)
+{
+	ThreadId = id;
+	LoadRoot();
+	RootNI = NI;
+	SearchAborted = false;
+	memset(History, 0, sizeof(History));
+	for (int i = 0; i < 64; i++) NI[i].Killer1 = NI[i].Killer2 = NullMove;
+	Nodes = 0;
+	CheckNodes = NodesCheckIntervalMin;
+	NI->eval = Eval();
+
+	//      ,
+	//       
+	for (uint8 depth = 1 + (id & 1); depth <= DepthLimit; depth++)
+	{
+		SearchPV(-MATE, MATE, depth);
+		if (SearchAborted) break;
+	}
+	ThreadNodes[id].store(Nodes, memory_order_relaxed);
+}
+
+//   
+void StartHelpers()
+{
+	StopThreads = false;
+	if (Threads < 2) return;
+
+	SaveRoot();
+	for (uint8 i = 1; i < Threads; i++)
+	{
+		ThreadNodes[i].store(0, memory_order_relaxed);
+		Helpers[i] = thread(HelperSearch, i);
+	}
+}
+
+//   
+void StopHelpers()
+{
+	StopThreads = true;
+	for (uint8 i = 1; i < MaxThreads; i++)
+	{
+		if (Helpers[i].joinable()) Helpers[i].join();
+	}
+}
+
+//    
+void SetThreads(int n)
+{
+	if (n < 1) n = 1;
+	else if (n > MaxThreads) n = MaxThreads;
+	Threads = n;
+}
+
+//  ,   
+uint64 TotalNodes()
+{
+	uint64 n = Nodes;
+	for (uint8 i = 1; i < Threads; i++) n += ThreadNodes[i].load(memory_order_relaxed);
+	return n;
+}
+
+//    
+Move RootSearch()
+{
+	TransNewSearch();
+	StartHelpers();
+	Move m = MainSearch();
+	StopHelpers();
+	return m;
+}
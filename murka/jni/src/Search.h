@@ -5,6 +5,8 @@
 #include "Moves.h"
 
 Move RootSearch();
+uint64 TotalNodes();
+void SetThreads(int n);
 inline bool Repetition();
 __int16 QuiescenceSearch(__int16 alpha, __int16 beta, uint8 gencheck);
 
@@ -41,12 +43,16 @@ struct NodeInfo
 //  
 const __int16 MATE = 0x7fff;
 
+//    
+const uint8 MaxThreads = 64;
+
 extern uint8 DepthLimit;
 extern uint64 NodesLimit;
-extern uint64 Nodes;
-extern NodeInfo *NI;
-extern NodeInfo NodesInfo[1024];
-extern uint32 History[13][64];
+extern uint8 Threads;
+extern TLS uint64 Nodes;
+extern TLS NodeInfo *NI;
+extern TLS NodeInfo NodesInfo[1024];
+extern TLS uint32 History[13][64];
 extern Move NullMove;
 
 #endif
@@ -38,7 +38,8 @@ void Perft(uint8 depth)
 	depth--;
 
 #ifdef TEST
-	TransEntry *he = Trans + (NI->HashKey & HashMask);
+	// perft        xor  
+	TransEntry *he = TransBucket(NI->HashKey);
 	if (he->Key == NI->HashKey && he->Depth == depth)
 	{
 		PerftNodes += he->Nodes;
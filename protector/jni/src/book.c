@@ -18,17 +18,174 @@
 
 */
 
+#if __STDC_VERSION__ >= 199901L
+#define _XOPEN_SOURCE 600
+#else
+#define _XOPEN_SOURCE 500
+#endif /* __STDC_VERSION__ */
+
 #include "book.h"
 #include "io.h"
 #include "pgn.h"
+#include "coordination.h"
 #include <string.h>
 #include <assert.h>
 #include <stdlib.h>
 #include <time.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef TARGET_LINUX
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#define BOOK_BATCH_SIZE 8192    /* games parsed between two book merges */
 
 static const UINT32 ILLEGAL_OFFSET = 0xFFFFFFFF;
 Book globalBook;
 
+typedef struct
+{
+   UINT64 hashKey;
+   BookMove move;
+}
+BookUpdate;
+
+typedef struct
+{
+   pthread_t thread;
+   PGNFile *pgnfile;
+   int maximumNumberOfPlies;
+   BookUpdate *updates;
+   long numUpdates, updateListSize;
+}
+BookWorker;
+
+typedef struct
+{
+   UINT64 hashKey;
+   CompactBookMove move;
+}
+BookBuilderEntry;
+
+typedef struct
+{
+   BookBuilderEntry *entries;
+   UINT64 size, count;
+}
+BookBuilder;
+
+typedef void (*BookUpdateMerger) (void *target, const BookUpdate * updates,
+                                  long numUpdates);
+
+static volatile long nextBookGame, lastBookGame;
+
+static void initializeCompactBook(Book * book)
+{
+   book->compactData = 0;
+   book->compactSize = 0;
+   book->compactMapped = FALSE;
+   book->compactPositions = 0;
+   book->compactMoves = 0;
+}
+
+static void releaseCompactBook(Book * book)
+{
+   if (book->compactData != 0)
+   {
+#ifdef TARGET_LINUX
+      if (book->compactMapped)
+      {
+         munmap(book->compactData, book->compactSize);
+      }
+      else
+#endif
+      {
+         free(book->compactData);
+      }
+   }
+
+   initializeCompactBook(book);
+}
+
+static int loadCompactBook(Book * book, const char *filename)
+{
+   const CompactBookHeader *header;
+   struct stat bookStatus;
+   FILE *file;
+
+   if (stat(filename, &bookStatus) != 0 ||
+       (size_t) bookStatus.st_size < sizeof(CompactBookHeader))
+   {
+      return -1;
+   }
+
+   book->compactSize = (size_t) bookStatus.st_size;
+
+#ifdef TARGET_LINUX
+   {
+      const int fd = open(filename, O_RDONLY);
+
+      if (fd >= 0)
+      {
+         void *data = mmap(0, book->compactSize, PROT_READ, MAP_SHARED,
+                           fd, 0);
+
+         close(fd);
+
+         if (data != MAP_FAILED)
+         {
+            book->compactData = data;
+            book->compactMapped = TRUE;
+         }
+      }
+   }
+#endif
+
+   if (book->compactData == 0 && (file = fopen(filename, "rb")) != 0)
+   {
+      if ((book->compactData = malloc(book->compactSize)) != 0 &&
+          fread(book->compactData, 1, book->compactSize, file) !=
+          book->compactSize)
+      {
+         free(book->compactData);
+         book->compactData = 0;
+      }
+
+      fclose(file);
+   }
+
+   if (book->compactData == 0)
+   {
+      return -1;
+   }
+
+   header = book->compactData;
+
+   if (header->magic != COMPACT_BOOK_MAGIC ||
+       header->version != COMPACT_BOOK_VERSION ||
+       book->compactSize != sizeof(CompactBookHeader) +
+       (size_t) header->numberOfPositions * sizeof(CompactBookPosition) +
+       (size_t) header->numberOfMoves * sizeof(CompactBookMove))
+   {
+      logDebug("Compact book '%s' is corrupt.\n", filename);
+      releaseCompactBook(book);
+
+      return -1;
+   }
+
+   book->compactPositions = (const CompactBookPosition *) (header + 1);
+   book->compactMoves = (const CompactBookMove *)
+      (book->compactPositions + header->numberOfPositions);
+   book->numberOfPositions = header->numberOfPositions;
+   book->numberOfMoves = header->numberOfMoves;
+   book->readonly = TRUE;
+
+   return 0;
+}
+
 int openBook(Book * book, const char *name)
 {
    char indexfileName[256], movefileName[256];
@@ -38,6 +195,22 @@ int openBook(Book * book, const char *name)
    strcpy(movefileName, name);
    strcat(movefileName, ".bkm");
 
+   book->indexFile = book->moveFile = NULL;
+   initializeCompactBook(book);
+
+   if (strlen(name) + strlen(COMPACT_BOOK_EXTENSION) < sizeof(indexfileName))
+   {
+      char compactfileName[256];
+
+      strcpy(compactfileName, name);
+      strcat(compactfileName, COMPACT_BOOK_EXTENSION);
+
+      if (loadCompactBook(book, compactfileName) == 0)
+      {
+         return 0;
+      }
+   }
+
    book->readonly = FALSE;
    book->indexFile = fopen(indexfileName, "r+");
    book->moveFile = fopen(movefileName, "r+");
@@ -104,12 +277,16 @@ void closeBook(Book * book)
    if (book->indexFile != NULL)
    {
       fclose(book->indexFile);
+      book->indexFile = NULL;
    }
 
    if (book->moveFile != NULL)
    {
       fclose(book->moveFile);
+      book->moveFile = NULL;
    }
+
+   releaseCompactBook(book);
 }
 
 static BookPosition loadBookposition(const Book * book, const UINT32 offset)
@@ -118,8 +295,7 @@ static BookPosition loadBookposition(const Book * book, const UINT32 offset)
 
    fseek(book->indexFile, offset, SEEK_SET);
 
-   if (fread(&position, sizeof(BookPosition), 1, book->indexFile) ==
-       sizeof(BookPosition))
+   if (fread(&position, sizeof(BookPosition), 1, book->indexFile) == 1)
    {
       return position;
    }
@@ -146,7 +322,7 @@ static BookMove loadBookmove(const Book * book, const UINT32 offset)
 
    fseek(book->moveFile, offset, SEEK_SET);
 
-   if (fread(&move, sizeof(BookMove), 1, book->moveFile) == sizeof(BookMove))
+   if (fread(&move, sizeof(BookMove), 1, book->moveFile) == 1)
    {
       return move;
    }
@@ -338,40 +514,81 @@ static void updateBookmove(BookMove * move, const Color activeColor,
    }
 }
 
-void addBookmove(Book * book, const Position * position,
-                 const Move move, const GameResult result,
-                 const bool personalResult)
+static void mergeBookmove(Book * book, const UINT64 hashKey,
+                          const BookMove * update)
 {
-   BookMove bookMove;
-   UINT32 bookmoveOffset;
-
-   bookMove.move = packedMove(move);
-   bookmoveOffset = getBookmoveOffset(book, position->hashKey, bookMove.move);
+   const UINT32 bookmoveOffset =
+      getBookmoveOffset(book, hashKey, update->move);
 
    if (bookmoveOffset == ILLEGAL_OFFSET)
    {
-      bookMove.numberOfGames = 0;
-      bookMove.score = 0;
-      bookMove.numberOfPersonalGames = 0;
-      bookMove.personalScore = 0;
-      bookMove.nextAlternative = ILLEGAL_OFFSET;
+      BookMove bookMove = *update;
 
-      updateBookmove(&bookMove, position->activeColor, result,
-                     personalResult);
-      appendBookmove(book, position->hashKey, &bookMove);
+      bookMove.nextAlternative = ILLEGAL_OFFSET;
+      appendBookmove(book, hashKey, &bookMove);
    }
    else
    {
-      bookMove = loadBookmove(book, bookmoveOffset);
+      BookMove bookMove = loadBookmove(book, bookmoveOffset);
 
-      updateBookmove(&bookMove, position->activeColor, result,
-                     personalResult);
+      bookMove.numberOfGames += update->numberOfGames;
+      bookMove.score += update->score;
+      bookMove.numberOfPersonalGames += update->numberOfPersonalGames;
+      bookMove.personalScore += update->personalScore;
       storeBookmove(book, &bookMove, bookmoveOffset);
    }
 }
 
-static void appendBookGame(Book * book, const PGNGame * game,
-                           const int maximumNumberOfPlies)
+static void initializeBookmove(BookMove * bookMove, const Move move)
+{
+   bookMove->move = packedMove(move);
+   bookMove->numberOfGames = 0;
+   bookMove->score = 0;
+   bookMove->numberOfPersonalGames = 0;
+   bookMove->personalScore = 0;
+   bookMove->nextAlternative = ILLEGAL_OFFSET;
+}
+
+void addBookmove(Book * book, const Position * position,
+                 const Move move, const GameResult result,
+                 const bool personalResult)
+{
+   BookMove bookMove;
+
+   initializeBookmove(&bookMove, move);
+   updateBookmove(&bookMove, position->activeColor, result, personalResult);
+   mergeBookmove(book, position->hashKey, &bookMove);
+}
+
+static void addBookUpdate(BookWorker * worker, const Position * position,
+                          const Move move, const GameResult result)
+{
+   BookUpdate *update;
+
+   if (worker->numUpdates == worker->updateListSize)
+   {
+      const long newSize = 2 * worker->updateListSize + 1024;
+      BookUpdate *updates =
+         realloc(worker->updates, newSize * sizeof(BookUpdate));
+
+      if (updates == 0)
+      {
+         logDebug("### Out of memory while reading the book games. ###\n");
+
+         exit(EXIT_FAILURE);
+      }
+
+      worker->updates = updates;
+      worker->updateListSize = newSize;
+   }
+
+   update = &worker->updates[worker->numUpdates++];
+   update->hashKey = position->hashKey;
+   initializeBookmove(&update->move, move);
+   updateBookmove(&update->move, position->activeColor, result, FALSE);
+}
+
+static void appendBookGame(BookWorker * worker, const PGNGame * game)
 {
    Gamemove *currentMove = game->firstMove;
    int plycount = 0;
@@ -399,41 +616,389 @@ static void appendBookGame(Book * book, const PGNGame * game,
       return;
    }
 
-   while (plycount++ < maximumNumberOfPlies && currentMove != 0)
+   while (plycount++ < worker->maximumNumberOfPlies && currentMove != 0)
    {
-      addBookmove(book, &currentMove->position,
-                  gameMove2Move(currentMove), result, FALSE);
+      addBookUpdate(worker, &currentMove->position,
+                    gameMove2Move(currentMove), result);
       currentMove = currentMove->nextMove;
    }
 }
 
-void appendBookDatabase(Book * book, const char *filename,
-                        int maximumNumberOfPlies)
+static int compareBookUpdates(const void *first, const void *second)
 {
+   const BookUpdate *update1 = first, *update2 = second;
+
+   if (update1->hashKey != update2->hashKey)
+   {
+      return (update1->hashKey < update2->hashKey ? -1 : 1);
+   }
+
+   return (int) update1->move.move - (int) update2->move.move;
+}
+
+/**
+ * Sort the updates of a worker and sum up the updates of identical moves
+ * so that every book move is touched only once per merge.
+ */
+static void condenseBookUpdates(BookWorker * worker)
+{
+   long i, numCondensed = 0;
+
+   qsort(worker->updates, worker->numUpdates, sizeof(BookUpdate),
+         compareBookUpdates);
+
+   for (i = 0; i < worker->numUpdates; i++)
+   {
+      const BookUpdate *update = &worker->updates[i];
+
+      if (numCondensed > 0 &&
+          compareBookUpdates(&worker->updates[numCondensed - 1],
+                             update) == 0)
+      {
+         BookMove *move = &worker->updates[numCondensed - 1].move;
+
+         move->numberOfGames += update->move.numberOfGames;
+         move->score += update->move.score;
+         move->numberOfPersonalGames += update->move.numberOfPersonalGames;
+         move->personalScore += update->move.personalScore;
+      }
+      else
+      {
+         worker->updates[numCondensed++] = *update;
+      }
+   }
+
+   worker->numUpdates = numCondensed;
+}
+
+static void *processBookGames(void *arg)
+{
+   BookWorker *worker = arg;
+   long gameNumber;
+
+   while ((gameNumber = __sync_add_and_fetch(&nextBookGame, 1)) <=
+          lastBookGame)
+   {
+      PGNGame *game = getGame(worker->pgnfile, (int) gameNumber);
+
+      if (game != 0)
+      {
+         appendBookGame(worker, game);
+         freePgnGame(game);
+      }
+   }
+
+   condenseBookUpdates(worker);
+
+   return 0;
+}
+
+static int processBookDatabase(const char *filename,
+                               int maximumNumberOfPlies,
+                               BookUpdateMerger mergeUpdates, void *target)
+{
+   BookWorker workers[MAX_THREADS];
+   const int numWorkers = getNumberOfThreads();
    PGNFile pgnfile;
-   PGNGame *game;
-   long i;
+   long firstGame;
+   int i;
 
    if (openPGNFile(&pgnfile, filename) != 0)
    {
-      return;
+      return -1;
+   }
+
+   logReport("\nProcessing book file '%s' [%ld game(s)] with %d thread(s)\n",
+             filename, pgnfile.numGames, numWorkers);
+
+   for (i = 0; i < numWorkers; i++)
+   {
+      workers[i].pgnfile = &pgnfile;
+      workers[i].maximumNumberOfPlies = maximumNumberOfPlies;
+      workers[i].updates = 0;
+      workers[i].numUpdates = workers[i].updateListSize = 0;
    }
 
-   logReport("\nProcessing book file '%s' [%ld game(s)]\n", filename,
-             pgnfile.numGames);
+   for (firstGame = 1; firstGame <= pgnfile.numGames;
+        firstGame += BOOK_BATCH_SIZE)
+   {
+      nextBookGame = firstGame - 1;
+      lastBookGame = min(firstGame + BOOK_BATCH_SIZE - 1, pgnfile.numGames);
+
+      for (i = 1; i < numWorkers; i++)
+      {
+         if (pthread_create(&workers[i].thread, NULL, &processBookGames,
+                            &workers[i]) != 0)
+         {
+            logDebug("### Book thread #%d could not be started. ###\n", i);
+
+            exit(EXIT_FAILURE);
+         }
+      }
+
+      processBookGames(&workers[0]);
+
+      for (i = 1; i < numWorkers; i++)
+      {
+         pthread_join(workers[i].thread, 0);
+      }
 
-   for (i = 1; i <= pgnfile.numGames; i++)
+      /* The merge targets are not thread safe; one worker at a time. */
+      for (i = 0; i < numWorkers; i++)
+      {
+         mergeUpdates(target, workers[i].updates, workers[i].numUpdates);
+         workers[i].numUpdates = 0;
+      }
+
+      logReport("Processed %ld of %ld book game(s).\n", lastBookGame,
+                pgnfile.numGames);
+   }
+
+   for (i = 0; i < numWorkers; i++)
    {
-      game = getGame(&pgnfile, i);
-      logReport("Processing book game #%ld.\n", i);
-      appendBookGame(book, game, maximumNumberOfPlies);
-      freePgnGame(game);
+      free(workers[i].updates);
    }
 
    closePGNFile(&pgnfile);
+
+   return 0;
 }
 
-static int getSuccessProbability(UINT16 numGames, INT16 score)
+static void mergeIntoBookfile(void *target, const BookUpdate * updates,
+                              long numUpdates)
+{
+   long i;
+
+   for (i = 0; i < numUpdates; i++)
+   {
+      mergeBookmove((Book *) target, updates[i].hashKey, &updates[i].move);
+   }
+}
+
+void appendBookDatabase(Book * book, const char *filename,
+                        int maximumNumberOfPlies)
+{
+   processBookDatabase(filename, maximumNumberOfPlies, &mergeIntoBookfile,
+                       book);
+}
+
+static UINT64 getBuilderIndex(const BookBuilder * builder,
+                              const UINT64 hashKey, const UINT16 move)
+{
+   return (hashKey ^ (move * 0x9E3779B97F4A7C15llu)) & (builder->size - 1);
+}
+
+static bool builderEntryIsUsed(const BookBuilderEntry * entry)
+{
+   return entry->move.numberOfGames + entry->move.numberOfPersonalGames > 0;
+}
+
+static BookBuilderEntry *getBuilderEntry(BookBuilder * builder,
+                                         const UINT64 hashKey,
+                                         const UINT16 move)
+{
+   UINT64 index = getBuilderIndex(builder, hashKey, move);
+
+   while (builderEntryIsUsed(&builder->entries[index]) &&
+          (builder->entries[index].hashKey != hashKey ||
+           builder->entries[index].move.move != move))
+   {
+      index = (index + 1) & (builder->size - 1);
+   }
+
+   return &builder->entries[index];
+}
+
+static int resizeBookBuilder(BookBuilder * builder, const UINT64 size)
+{
+   BookBuilderEntry *oldEntries = builder->entries;
+   const UINT64 oldSize = builder->size;
+   UINT64 i;
+
+   builder->entries = calloc(size, sizeof(BookBuilderEntry));
+
+   if (builder->entries == 0)
+   {
+      builder->entries = oldEntries;
+
+      return -1;
+   }
+
+   builder->size = size;
+
+   for (i = 0; i < oldSize; i++)
+   {
+      if (builderEntryIsUsed(&oldEntries[i]))
+      {
+         *getBuilderEntry(builder, oldEntries[i].hashKey,
+                          oldEntries[i].move.move) = oldEntries[i];
+      }
+   }
+
+   free(oldEntries);
+
+   return 0;
+}
+
+static void mergeIntoBookBuilder(void *target, const BookUpdate * updates,
+                                 long numUpdates)
+{
+   BookBuilder *builder = target;
+   long i;
+
+   for (i = 0; i < numUpdates; i++)
+   {
+      const BookMove *update = &updates[i].move;
+      BookBuilderEntry *entry;
+
+      if (2 * (builder->count + 1) > builder->size &&
+          resizeBookBuilder(builder, 2 * builder->size) != 0)
+      {
+         logDebug("### Out of memory while building the book. ###\n");
+
+         exit(EXIT_FAILURE);
+      }
+
+      entry = getBuilderEntry(builder, updates[i].hashKey, update->move);
+
+      if (builderEntryIsUsed(entry) == FALSE)
+      {
+         entry->hashKey = updates[i].hashKey;
+         entry->move.move = update->move;
+         builder->count++;
+      }
+
+      entry->move.numberOfGames += update->numberOfGames;
+      entry->move.score += update->score;
+      entry->move.numberOfPersonalGames += update->numberOfPersonalGames;
+      entry->move.personalScore += update->personalScore;
+   }
+}
+
+static int compareBuilderEntries(const void *first, const void *second)
+{
+   const BookBuilderEntry *entry1 = first, *entry2 = second;
+
+   if (entry1->hashKey != entry2->hashKey)
+   {
+      return (entry1->hashKey < entry2->hashKey ? -1 : 1);
+   }
+
+   return (int) entry1->move.move - (int) entry2->move.move;
+}
+
+static int writeCompactBook(BookBuilder * builder, const char *filename)
+{
+   CompactBookHeader header;
+   CompactBookPosition position;
+   UINT64 i, numEntries = 0;
+   bool written = TRUE;
+   FILE *file;
+
+   /* Pack the used entries and sort them by position. */
+   for (i = 0; i < builder->size; i++)
+   {
+      if (builderEntryIsUsed(&builder->entries[i]))
+      {
+         builder->entries[numEntries++] = builder->entries[i];
+      }
+   }
+
+   qsort(builder->entries, numEntries, sizeof(BookBuilderEntry),
+         compareBuilderEntries);
+
+   header.magic = COMPACT_BOOK_MAGIC;
+   header.version = COMPACT_BOOK_VERSION;
+   header.numberOfPositions = 0;
+   header.numberOfMoves = (UINT32) numEntries;
+
+   for (i = 0; i < numEntries; i++)
+   {
+      if (i == 0 ||
+          builder->entries[i].hashKey != builder->entries[i - 1].hashKey)
+      {
+         header.numberOfPositions++;
+      }
+   }
+
+   if ((file = fopen(filename, "wb")) == 0)
+   {
+      return -1;
+   }
+
+   setvbuf(file, 0, _IOFBF, 1 << 20);
+   written = (fwrite(&header, sizeof(header), 1, file) == 1);
+
+   for (i = 0; i < numEntries && written; i++)
+   {
+      if (i == 0 ||
+          builder->entries[i].hashKey != builder->entries[i - 1].hashKey)
+      {
+         position.hashKey = builder->entries[i].hashKey;
+         position.firstMove = (UINT32) i;
+         position.numberOfMoves = 0;
+
+         while (i + position.numberOfMoves < numEntries &&
+                builder->entries[i + position.numberOfMoves].hashKey ==
+                position.hashKey)
+         {
+            position.numberOfMoves++;
+         }
+
+         written = (fwrite(&position, sizeof(position), 1, file) == 1);
+      }
+   }
+
+   for (i = 0; i < numEntries && written; i++)
+   {
+      written = (fwrite(&builder->entries[i].move, sizeof(CompactBookMove),
+                        1, file) == 1);
+   }
+
+   if (fclose(file) != 0 || written == FALSE)
+   {
+      remove(filename);
+
+      return -1;
+   }
+
+   logReport("Book '%s' written: %lu positions, %lu moves.\n", filename,
+             (unsigned long) header.numberOfPositions,
+             (unsigned long) header.numberOfMoves);
+
+   return 0;
+}
+
+int buildBook(const char *name, const char *filename,
+              int maximumNumberOfPlies)
+{
+   BookBuilder builder;
+   char *compactfileName =
+      malloc(strlen(name) + strlen(COMPACT_BOOK_EXTENSION) + 1);
+   int result = -1;
+
+   builder.entries = 0;
+   builder.size = builder.count = 0;
+
+   if (compactfileName != 0 && resizeBookBuilder(&builder, 1 << 16) == 0)
+   {
+      strcpy(compactfileName, name);
+      strcat(compactfileName, COMPACT_BOOK_EXTENSION);
+
+      if (processBookDatabase(filename, maximumNumberOfPlies,
+                              &mergeIntoBookBuilder, &builder) == 0)
+      {
+         result = writeCompactBook(&builder, compactfileName);
+      }
+   }
+
+   free(builder.entries);
+   free(compactfileName);
+
+   return result;
+}
+
+static int getSuccessProbability(UINT32 numGames, INT32 score)
 {
    int result;
 
@@ -442,14 +1007,15 @@ static int getSuccessProbability(UINT16 numGames, INT16 score)
       return 0;
    }
 
-   result = (50 * (long) (numGames + score)) / (long) numGames;
+   result = (int) ((50 * (INT64) (numGames + score)) / (INT64) numGames);
 
    assert(result >= 0 && result <= 100);
 
    return result;
 }
 
-static int getBookmoveValue(const BookMove * move, const UINT32 numberOfGames)
+static int getBookmoveValue(const CompactBookMove * move,
+                            const UINT32 numberOfGames)
 {
    const int weightGames = 10, weightPersonalGames = 1;
    int successProbability, personalSuccessProbability, moveProbability;
@@ -458,7 +1024,9 @@ static int getBookmoveValue(const BookMove * move, const UINT32 numberOfGames)
       getSuccessProbability(move->numberOfGames, move->score);
    personalSuccessProbability =
       getSuccessProbability(move->numberOfPersonalGames, move->personalScore);
-   moveProbability = (move->numberOfGames * 100) / numberOfGames;
+   moveProbability = (numberOfGames == 0 ? 0 :
+                      (int) (((UINT64) move->numberOfGames * 100) /
+                             numberOfGames));
 
    successProbability = (successProbability * weightGames +
                          personalSuccessProbability * weightPersonalGames) /
@@ -467,16 +1035,68 @@ static int getBookmoveValue(const BookMove * move, const UINT32 numberOfGames)
    return successProbability * moveProbability;
 }
 
-void getBookmoves(const Book * book, const UINT64 hashKey,
-                  const Movelist * legalMoves, Movelist * bookMoves)
+static const CompactBookPosition *findCompactBookposition(const Book * book,
+                                                          const UINT64
+                                                          hashKey)
+{
+   UINT32 low = 0, high = book->numberOfPositions;
+
+   while (low < high)
+   {
+      const UINT32 middle = low + (high - low) / 2;
+
+      if (book->compactPositions[middle].hashKey < hashKey)
+      {
+         low = middle + 1;
+      }
+      else
+      {
+         high = middle;
+      }
+   }
+
+   return (low < book->numberOfPositions &&
+           book->compactPositions[low].hashKey == hashKey ?
+           &book->compactPositions[low] : 0);
+}
+
+static void getCompactBookmoves(const Book * book, const UINT64 hashKey,
+                                const Movelist * legalMoves,
+                                Movelist * bookMoves,
+                                CompactBookMove * bookMoveStore)
+{
+   const CompactBookPosition *position =
+      findCompactBookposition(book, hashKey);
+   UINT32 i;
+
+   if (position == 0)
+   {
+      return;
+   }
+
+   for (i = 0; i < position->numberOfMoves &&
+        bookMoves->numberOfMoves < MAX_MOVES_PER_POSITION; i++)
+   {
+      const CompactBookMove *bookMove =
+         &book->compactMoves[position->firstMove + i];
+      const Move move = (Move) bookMove->move;
+
+      if (listContainsMove(legalMoves, move))
+      {
+         bookMoveStore[bookMoves->numberOfMoves] = *bookMove;
+         bookMoves->moves[bookMoves->numberOfMoves++] = move;
+      }
+   }
+}
+
+static void getBookfileMoves(const Book * book, const UINT64 hashKey,
+                             const Movelist * legalMoves,
+                             Movelist * bookMoves,
+                             CompactBookMove * bookMoveStore)
 {
    UINT32 positionOffset = getBookpositionOffset(book, hashKey), moveOffset;
    BookPosition position;
-   BookMove bookMove, bookMoveStore[MAX_MOVES_PER_POSITION];
-   UINT32 numberOfGames = 0;
-   int i;
-
-   bookMoves->numberOfMoves = 0;
+   BookMove bookMove;
 
    if (positionOffset == ILLEGAL_OFFSET)
    {
@@ -495,13 +1115,44 @@ void getBookmoves(const Book * book, const UINT64 hashKey,
 
       if (listContainsMove(legalMoves, move))
       {
-         numberOfGames += bookMove.numberOfGames;
-         bookMoveStore[bookMoves->numberOfMoves] = bookMove;
+         CompactBookMove *storedMove =
+            &bookMoveStore[bookMoves->numberOfMoves];
+
+         storedMove->move = bookMove.move;
+         storedMove->numberOfGames = bookMove.numberOfGames;
+         storedMove->score = bookMove.score;
+         storedMove->numberOfPersonalGames = bookMove.numberOfPersonalGames;
+         storedMove->personalScore = bookMove.personalScore;
          bookMoves->moves[bookMoves->numberOfMoves++] = move;
       }
 
       moveOffset = bookMove.nextAlternative;
    }
+}
+
+void getBookmoves(const Book * book, const UINT64 hashKey,
+                  const Movelist * legalMoves, Movelist * bookMoves)
+{
+   CompactBookMove bookMoveStore[MAX_MOVES_PER_POSITION];
+   UINT32 numberOfGames = 0;
+   int i;
+
+   bookMoves->numberOfMoves = 0;
+
+   if (book->compactData != 0)
+   {
+      getCompactBookmoves(book, hashKey, legalMoves, bookMoves,
+                          bookMoveStore);
+   }
+   else
+   {
+      getBookfileMoves(book, hashKey, legalMoves, bookMoves, bookMoveStore);
+   }
+
+   for (i = 0; i < bookMoves->numberOfMoves; i++)
+   {
+      numberOfGames += bookMoveStore[i].numberOfGames;
+   }
 
    for (i = 0; i < bookMoves->numberOfMoves; i++)
    {
@@ -550,7 +1201,8 @@ Move getBookmove(const Book * book, const UINT64 hashKey,
    Movelist bookMoves;
    Move move = NO_MOVE;
 
-   if (book->indexFile != 0 && book->moveFile != 0 &&
+   if ((book->compactData != 0 ||
+        (book->indexFile != 0 && book->moveFile != 0)) &&
        book->numberOfPositions > 0 && book->numberOfMoves > 0)
    {
       initMovelist(&bookMoves, 0);
@@ -649,6 +1301,58 @@ static int testMoveOperations()
    return 0;
 }
 
+static int testCompactBook()
+{
+   Book book;
+   BookBuilder builder;
+   BookUpdate updates[3];
+   Movelist legalMoves, bookMoves;
+   const UINT64 hashKey = 4711;
+   int i, result;
+
+   for (i = 0; i < 3; i++)
+   {
+      updates[i].hashKey = (i < 2 ? hashKey : hashKey + BOOKINDEX_SIZE);
+      initializeBookmove(&updates[i].move, (Move) (17 + i));
+      updates[i].move.numberOfGames = (UINT16) (i + 1);
+      updates[i].move.score = 1;
+   }
+
+   builder.entries = 0;
+   builder.size = builder.count = 0;
+   result = resizeBookBuilder(&builder, 2);
+   assert(result == 0);
+   mergeIntoBookBuilder(&builder, updates, 3);
+   mergeIntoBookBuilder(&builder, updates, 1);
+   assert(builder.count == 3 && builder.size >= 8);
+   result = writeCompactBook(&builder, "moduletest.bkc");
+   assert(result == 0);
+   free(builder.entries);
+
+   result = openBook(&book, "moduletest");
+   assert(result == 0);
+   assert(book.compactData != 0);
+   assert(book.numberOfPositions == 2 && book.numberOfMoves == 3);
+   assert(findCompactBookposition(&book, hashKey)->numberOfMoves == 2);
+   assert(book.compactMoves[0].move == 17);
+   assert(book.compactMoves[0].numberOfGames == 2);
+   assert(book.compactMoves[0].score == 2);
+   assert(findCompactBookposition(&book, hashKey + 1) == 0);
+
+   legalMoves.numberOfMoves = 2;
+   legalMoves.moves[0] = 18;
+   legalMoves.moves[1] = 19;
+   getBookmoves(&book, hashKey, &legalMoves, &bookMoves);
+   assert(bookMoves.numberOfMoves == 1);
+   assert((bookMoves.moves[0] & 0xFFFF) == 18);
+
+   closeBook(&book);
+   result = remove("moduletest.bkc");
+   assert(result == 0);
+
+   return result;
+}
+
 int testModuleBook()
 {
    int result;
@@ -663,5 +1367,10 @@ int testModuleBook()
       return result;
    }
 
+   if ((result = testCompactBook()) != 0)
+   {
+      return result;
+   }
+
    return 0;
 }
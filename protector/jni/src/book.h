@@ -50,18 +50,60 @@ typedef struct
 }
 BookMove;
 
+/*
+ * The compact book format (name.bkc) is written in one pass by
+ * buildBook: a header, all positions sorted by hash key and finally
+ * the moves, grouped by position.
+ */
+#define COMPACT_BOOK_EXTENSION ".bkc"
+#define COMPACT_BOOK_MAGIC 0x43424b50
+#define COMPACT_BOOK_VERSION 1
+
+typedef struct
+{
+   UINT32 magic, version;
+   UINT32 numberOfPositions, numberOfMoves;
+}
+CompactBookHeader;
+
+typedef struct
+{
+   UINT64 hashKey;
+   UINT32 firstMove;
+   UINT32 numberOfMoves;
+}
+CompactBookPosition;
+
+typedef struct
+{
+   UINT16 move, padding;
+   UINT32 numberOfGames;
+   INT32 score;
+   UINT32 numberOfPersonalGames;
+   INT32 personalScore;
+}
+CompactBookMove;
+
 typedef struct
 {
    FILE *indexFile, *moveFile;
    bool readonly;
    UINT32 numberOfPositions, numberOfMoves;
+
+   /* set if the book was opened in the compact format */
+   void *compactData;
+   size_t compactSize;
+   bool compactMapped;
+   const CompactBookPosition *compactPositions;
+   const CompactBookMove *compactMoves;
 }
 Book;
 
 extern Book globalBook;
 
 /**
- * Open the book specified by 'name'.
+ * Open the book specified by 'name'. A compact book 'name.bkc' is
+ * preferred over the updatable files 'name.bki' and 'name.bkm'.
  *
  * @return 0 if no errors occurred.
  */
@@ -107,6 +149,15 @@ void addBookmove(Book * book, const Position * position,
 void appendBookDatabase(Book * book, const char *filename,
                         int maximumNumberOfPlies);
 
+/**
+ * Build the compact book 'name.bkc' from the database 'filename'.
+ * All moves are collected in memory and written in one pass.
+ *
+ * @return 0 if no errors occurred.
+ */
+int buildBook(const char *name, const char *filename,
+              int maximumNumberOfPlies);
+
 /**
  * Initialize this module.
  *
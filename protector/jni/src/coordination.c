@@ -29,6 +29,7 @@
 #include "matesearch.h"
 #include "io.h"
 #include "hash.h"
+#include "evaluation.h"
 #include "test.h"
 #include "xboard.h"
 #include <stdio.h>
@@ -38,19 +39,48 @@
 
 /* #define DEBUG_COORDINATION */
 
-pthread_t searchThread[MAX_THREADS];
-pthread_t timer;
-
 static pthread_mutex_t guiSearchMutex = PTHREAD_MUTEX_INITIALIZER;
 
-long searchThreadId[MAX_THREADS];
+/*
+ * The search threads are created once and then wait for tasks. A task is
+ * published by incrementing taskGeneration under poolMutex and
+ * broadcasting taskStarted. The last participating thread to finish
+ * broadcasts taskFinished.
+ */
+static pthread_t searchThread[MAX_THREADS];
+static int poolSize = 0;
+static pthread_mutex_t poolMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t taskStarted = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t taskFinished = PTHREAD_COND_INITIALIZER;
+static unsigned long taskGeneration = 0;
+static int numTaskThreads = 0;
+static int activeSearchThreads = 0;
+
+/*
+ * A single timer thread sleeps until the deadline of the current task
+ * or until it is rearmed or disarmed. Each change of the timer
+ * increments timerId, so that a stale deadline never aborts a search.
+ */
+static pthread_t timer;
+static bool timerStarted = FALSE;
+static pthread_mutex_t timerMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t timerChanged = PTHREAD_COND_INITIALIZER;
+static bool timerArmed = FALSE;
+static struct timespec timerDeadline;
+static unsigned long timerId = 0;
 
 static int numThreads = 1;
 static SearchTask dummyTask;
 static SearchTask *currentTask = &dummyTask;
 static Variation variations[MAX_THREADS];
 static Hashtable sharedHashtable;
-static PawnHashInfo pawnHashtable[MAX_THREADS][PAWN_HASHTABLE_SIZE];
+static MateSearch mateSearch;
+static PawnHashtable pawnHashtable[MAX_THREADS];
+static KingSafetyHashtable kingsafetyHashtable[MAX_THREADS];
+static UINT64 pawnHashtableSize =
+   (UINT64) PAWN_HASHTABLE_DEFAULT_SIZE_MB * 1024 * 1024;
+static UINT64 kingsafetyHashtableSize =
+   (UINT64) KINGSAFETY_HASHTABLE_DEFAULT_SIZE_MB * 1024 * 1024;
 
 Hashtable *getSharedHashtable(void)
 {
@@ -109,8 +139,33 @@ void releaseGuiSearchMutex(void)
 #endif
 }
 
+/**
+ * Allocate the pawn and king safety hashtables of the calling search
+ * thread so that their pages are first touched by the thread using them.
+ */
+static void allocateEvalHashtables(Variation * currentVariation)
+{
+   if (currentVariation->pawnHashtable->table == 0)
+   {
+      setPawnHashtableSize(currentVariation->pawnHashtable,
+                           pawnHashtableSize);
+   }
+
+   if (currentVariation->kingsafetyHashtable->table == 0)
+   {
+      setKingsafetyHashtableSize(currentVariation->kingsafetyHashtable,
+                                 kingsafetyHashtableSize);
+   }
+
+   currentVariation->pawnHashtable->lookups =
+      currentVariation->pawnHashtable->hits = 0;
+   currentVariation->kingsafetyHashtable->lookups =
+      currentVariation->kingsafetyHashtable->hits = 0;
+}
+
 static int startSearch(Variation * currentVariation)
 {
+   allocateEvalHashtables(currentVariation);
    currentVariation->searchStatus = SEARCH_STATUS_RUNNING;
 
 #ifdef DEBUG_COORDINATION
@@ -130,13 +185,13 @@ static int startSearch(Variation * currentVariation)
       break;
 
    case TASKTYPE_MATE_IN_N:
-      searchForMate(currentVariation,
+      searchForMate(currentVariation, &mateSearch,
                     &currentTask->calculatedSolutions,
                     currentTask->numberOfMoves);
       break;
 
    case TASKTYPE_TEST_MATE_IN_N:
-      searchForMate(currentVariation,
+      searchForMate(currentVariation, &mateSearch,
                     &currentTask->calculatedSolutions,
                     currentTask->numberOfMoves);
       break;
@@ -151,12 +206,12 @@ static int startSearch(Variation * currentVariation)
    {
       int threadCount;
 
-      for (threadCount = 1; threadCount < numThreads; threadCount++)
+      for (threadCount = 1; threadCount < numTaskThreads; threadCount++)
       {
          variations[threadCount].terminate = TRUE;
       }
 
-      pthread_cancel(timer);
+      stopTimer();
    }
 
 #ifdef DEBUG_COORDINATION
@@ -176,9 +231,32 @@ long getElapsedTime(void)
 
 static void *executeSearch(void *arg)
 {
-   Variation *currentVariation = arg;
+   const int threadNumber = (int) (size_t) arg;
+   unsigned long generation = 0;
+
+   pthread_mutex_lock(&poolMutex);
+
+   while (TRUE)
+   {
+      while (generation == taskGeneration)
+      {
+         pthread_cond_wait(&taskStarted, &poolMutex);
+      }
 
-   startSearch(currentVariation);
+      generation = taskGeneration;
+
+      if (threadNumber < numTaskThreads)
+      {
+         pthread_mutex_unlock(&poolMutex);
+         startSearch(&variations[threadNumber]);
+         pthread_mutex_lock(&poolMutex);
+
+         if (--activeSearchThreads == 0)
+         {
+            pthread_cond_broadcast(&taskFinished);
+         }
+      }
+   }
 
    return 0;
 }
@@ -195,58 +273,122 @@ void handleSearchEvent(int eventId, Variation * variation)
    }
 }
 
-static void *watchTime(void *arg)
+static bool timerDeadlineReached(void)
 {
-   Variation *currentVariation = arg;
-   long timeLimit = currentVariation->timeLimit;
-   struct timespec requested, remaining;
-   int result;
+   struct timespec now;
 
-   requested.tv_sec = timeLimit / 1000;
-   requested.tv_nsec = 1000000 * (timeLimit - 1000 * requested.tv_sec);
+   clock_gettime(CLOCK_REALTIME, &now);
 
-   /* logReport("### Timer thread working sec=%ld nsec=%ld ###\n",
-      requested.tv_sec, requested.tv_nsec); */
+   return (bool) (now.tv_sec > timerDeadline.tv_sec ||
+                  (now.tv_sec == timerDeadline.tv_sec &&
+                   now.tv_nsec >= timerDeadline.tv_nsec));
+}
 
-   result = nanosleep(&requested, &remaining);
+static void *watchTime(void *arg)
+{
+   pthread_mutex_lock(&timerMutex);
 
-   if (result != -1)
+   while (TRUE)
    {
-      getGuiSearchMutex();
-      prepareSearchAbort();
-      releaseGuiSearchMutex();
+      if (timerArmed == FALSE)
+      {
+         pthread_cond_wait(&timerChanged, &timerMutex);
+      }
+      else if (timerDeadlineReached() == FALSE)
+      {
+         pthread_cond_timedwait(&timerChanged, &timerMutex, &timerDeadline);
+      }
+      else
+      {
+         const unsigned long firedId = timerId;
+
+         timerArmed = FALSE;
+
+         /* The gui mutex is always acquired before the timer mutex. */
+         pthread_mutex_unlock(&timerMutex);
+         getGuiSearchMutex();
+         pthread_mutex_lock(&timerMutex);
+
+         if (timerId == firedId)
+         {
+            prepareSearchAbort();
+         }
+
+         pthread_mutex_unlock(&timerMutex);
+         releaseGuiSearchMutex();
+         pthread_mutex_lock(&timerMutex);
+      }
    }
 
    return 0;
 }
 
-void startTimerThread(SearchTask * task)
+void startTimer(SearchTask * task)
 {
    if (task->variation->timeLimit > 0 && task->variation->ponderMode == FALSE)
    {
-      if (pthread_create(&timer, NULL, &watchTime, task->variation) == 0)
+      const long timeLimit = task->variation->timeLimit;
+
+      pthread_mutex_lock(&timerMutex);
+
+      if (timerStarted == FALSE)
       {
-#ifdef DEBUG_COORDINATION
-         logDebug("Timer thread started.\n");
-#endif
+         if (pthread_create(&timer, NULL, &watchTime, 0) != 0)
+         {
+            logDebug("### Timer thread could not be started. ###\n");
+
+            exit(EXIT_FAILURE);
+         }
+
+         timerStarted = TRUE;
       }
-      else
-      {
-         logDebug("### Timer thread could not be started. ###\n");
 
-         exit(EXIT_FAILURE);
+      clock_gettime(CLOCK_REALTIME, &timerDeadline);
+      timerDeadline.tv_sec += timeLimit / 1000;
+      timerDeadline.tv_nsec += 1000000 * (timeLimit % 1000);
+
+      if (timerDeadline.tv_nsec >= 1000000000)
+      {
+         timerDeadline.tv_sec++;
+         timerDeadline.tv_nsec -= 1000000000;
       }
+
+      timerArmed = TRUE;
+      timerId++;
+      pthread_cond_signal(&timerChanged);
+      pthread_mutex_unlock(&timerMutex);
+
+#ifdef DEBUG_COORDINATION
+      logDebug("Timer armed.\n");
+#endif
    }
 }
 
+void stopTimer(void)
+{
+   pthread_mutex_lock(&timerMutex);
+   timerArmed = FALSE;
+   timerId++;
+   pthread_cond_signal(&timerChanged);
+   pthread_mutex_unlock(&timerMutex);
+}
+
 void scheduleTask(SearchTask * task)
 {
-   const unsigned long startTime = getTimestamp();
+   unsigned long startTime;
    int threadCount;
 
-   sharedHashtable.entriesUsed = 0;
+   pthread_mutex_lock(&poolMutex);
+
+   while (activeSearchThreads > 0)
+   {
+      pthread_cond_wait(&taskFinished, &poolMutex);
+   }
 
-   startTimerThread(task);
+   startTime = getTimestamp();
+   resetHashtableUsage(&sharedHashtable);
+   resetNodeUsageStatistics();
+   resetMateSearch(&mateSearch, numThreads);
 
    for (threadCount = 0; threadCount < numThreads; threadCount++)
    {
@@ -257,14 +399,18 @@ void scheduleTask(SearchTask * task)
       currentVariation->searchStatus = SEARCH_STATUS_TERMINATE;
       currentVariation->bestBaseMove = NO_MOVE;
       currentVariation->terminate = FALSE;
-      currentVariation->pawnHashtable = &(pawnHashtable[threadCount][0]);
+      currentVariation->pawnHashtable = &pawnHashtable[threadCount];
       currentVariation->kingsafetyHashtable =
-         &(kingSafetyHashtable[threadCount][0]);
+         &kingsafetyHashtable[threadCount];
+      currentVariation->hashtable = &sharedHashtable;
       currentVariation->threadNumber = threadCount;
       currentVariation->startTime = startTime;
+   }
 
+   for (threadCount = poolSize; threadCount < numThreads; threadCount++)
+   {
       if (pthread_create(&searchThread[threadCount], NULL,
-                         &executeSearch, currentVariation) == 0)
+                         &executeSearch, (void *) (size_t) threadCount) == 0)
       {
 #ifdef DEBUG_COORDINATION
          logDebug("Search thread #%d created.\n", threadCount);
@@ -277,58 +423,32 @@ void scheduleTask(SearchTask * task)
 
          exit(EXIT_FAILURE);
       }
+
+      poolSize = threadCount + 1;
    }
+
+   startTimer(task);
+
+   numTaskThreads = activeSearchThreads = numThreads;
+   taskGeneration++;
+   pthread_cond_broadcast(&taskStarted);
+   pthread_mutex_unlock(&poolMutex);
 }
 
 void waitForSearchTermination(void)
 {
-   int threadCount;
-   bool finished;
-   int count = 0;
+   pthread_mutex_lock(&poolMutex);
 
-   do
+   while (activeSearchThreads > 0)
    {
-      finished = TRUE;
-
-      if (count > 1000)
-      {
-         logDebug("waiting for search termination.\n");
-         count = 0;
-      }
+      pthread_cond_wait(&taskFinished, &poolMutex);
+   }
 
-      for (threadCount = 0; threadCount < numThreads; threadCount++)
-      {
-         Variation *currentVariation = &variations[threadCount];
-
-         if (currentVariation->searchStatus != SEARCH_STATUS_FINISHED)
-         {
-            if (searchThread[threadCount] != 0)
-            {
-               const int result = pthread_join(searchThread[threadCount], 0);
-
-               if (result == 0)
-               {
-                  searchThread[threadCount] = 0;
-               }
-               else
-               {
-                  finished = FALSE;
-               }
-            }
-         }
-         else
-         {
-            searchThread[threadCount] = 0;
-         }
+   pthread_mutex_unlock(&poolMutex);
 
 #ifdef DEBUG_COORDINATION
-         logDebug("Task %d finished.\n", threadCount);
+   logDebug("Task finished.\n");
 #endif
-      }
-
-      count++;
-   }
-   while (finished == FALSE);
 }
 
 void completeTask(SearchTask * task)
@@ -385,6 +505,57 @@ void setHashtableSizeInMb(unsigned int size)
    resetHashtable(&sharedHashtable);
 }
 
+void setPawnHashtableSizeInMb(unsigned int size)
+{
+   int threadCount;
+
+   pawnHashtableSize = 1024 * 1024 * (UINT64) size;
+
+   for (threadCount = 0; threadCount < MAX_THREADS; threadCount++)
+   {
+      deletePawnHashtable(&pawnHashtable[threadCount]);
+   }
+}
+
+void setKingsafetyHashtableSizeInMb(unsigned int size)
+{
+   int threadCount;
+
+   kingsafetyHashtableSize = 1024 * 1024 * (UINT64) size;
+
+   for (threadCount = 0; threadCount < MAX_THREADS; threadCount++)
+   {
+      deleteKingsafetyHashtable(&kingsafetyHashtable[threadCount]);
+   }
+}
+
+UINT64 getPawnHashtableSize(void)
+{
+   return pawnHashtableSize;
+}
+
+UINT64 getKingsafetyHashtableSize(void)
+{
+   return kingsafetyHashtableSize;
+}
+
+void getEvalHashStatistics(EvalHashStatistics * statistics)
+{
+   int threadCount;
+
+   statistics->pawnLookups = statistics->pawnHits = 0;
+   statistics->kingsafetyLookups = statistics->kingsafetyHits = 0;
+
+   for (threadCount = 0; threadCount < numThreads; threadCount++)
+   {
+      statistics->pawnLookups += pawnHashtable[threadCount].lookups;
+      statistics->pawnHits += pawnHashtable[threadCount].hits;
+      statistics->kingsafetyLookups +=
+         kingsafetyHashtable[threadCount].lookups;
+      statistics->kingsafetyHits += kingsafetyHashtable[threadCount].hits;
+   }
+}
+
 int initializeModuleCoordination(void)
 {
    int threadCount;
@@ -392,12 +563,50 @@ int initializeModuleCoordination(void)
    initializeHashtable(&sharedHashtable);
    setHashtableSize(&sharedHashtable, 16 * 1024 * 1024);
    resetHashtable(&sharedHashtable);
+   initializeMateSearch(&mateSearch);
 
    for (threadCount = 0; threadCount < MAX_THREADS; threadCount++)
    {
       Variation *currentVariation = &variations[threadCount];
 
       currentVariation->searchStatus = SEARCH_STATUS_FINISHED;
+      initializePawnHashtable(&pawnHashtable[threadCount]);
+      initializeKingsafetyHashtable(&kingsafetyHashtable[threadCount]);
+   }
+
+   return 0;
+}
+
+static int testTaskTermination(void)
+{
+   const char fen[] =
+      "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+   Variation variation;
+   SearchTask task;
+   int i;
+
+   task.type = TASKTYPE_BEST_MOVE;
+   task.variation = &variation;
+
+   /* Back to back tasks reuse the search threads and the timer. */
+   for (i = 0; i < 3; i++)
+   {
+      const unsigned long startTime = getTimestamp();
+
+      initializeVariation(&variation, fen);
+      variation.timeTarget = variation.timeLimit = 200;
+      variation.ponderMode = FALSE;
+      variation.handleUciEvents = FALSE;
+      completeTask(&task);
+
+      if (getTimestamp() - startTime >= 2000)
+      {
+         return -1;
+      }
+
+      assert(task.bestMove != NO_MOVE);
+      assert(activeSearchThreads == 0);
+      assert(poolSize >= numThreads);
    }
 
    return 0;
@@ -405,5 +614,12 @@ int initializeModuleCoordination(void)
 
 int testModuleCoordination(void)
 {
+   int result;
+
+   if ((result = testTaskTermination()) != 0)
+   {
+      return result;
+   }
+
    return 0;
 }
@@ -61,6 +61,36 @@ int getNumberOfThreads(void);
  */
 void setHashtableSizeInMb(unsigned int size);
 
+/**
+ * Set the size of the pawn hashtable of each search thread.
+ *
+ * @var size the size of each pawn hashtable in MB
+ */
+void setPawnHashtableSizeInMb(unsigned int size);
+
+/**
+ * Set the size of the king safety hashtable of each search thread.
+ *
+ * @var size the size of each king safety hashtable in MB
+ */
+void setKingsafetyHashtableSizeInMb(unsigned int size);
+
+/**
+ * Get the configured size of each pawn hashtable in bytes.
+ */
+UINT64 getPawnHashtableSize(void);
+
+/**
+ * Get the configured size of each king safety hashtable in bytes.
+ */
+UINT64 getKingsafetyHashtableSize(void);
+
+/**
+ * Sum up the lookups and hits of the pawn and king safety hashtables
+ * of all active threads since the current search was started.
+ */
+void getEvalHashStatistics(EvalHashStatistics * statistics);
+
 /**
  * Lock out either the gui or the search thread.
  */
@@ -73,13 +103,22 @@ void releaseGuiSearchMutex(void);
 
 /**
  * Schedule the specified task as the next task to be calculated.
+ * The search threads are taken from a pool that is created on demand.
+ * If the threads of the previous task are still busy, wait until they
+ * have finished; a running search must have been aborted beforehand.
  */
 void scheduleTask(SearchTask * task);
 
 /**
- * Start the timer of the specified task.
+ * Arm the timer with the time limit of the specified task. A previously
+ * armed deadline is replaced.
+ */
+void startTimer(SearchTask * task);
+
+/**
+ * Disarm the timer.
  */
-void startTimerThread(SearchTask * task);
+void stopTimer(void);
 
 /**
  * Get the elapsed time of the current search.
@@ -103,7 +142,8 @@ void prepareSearchAbort(void);
 void unsetPonderMode(void);
 
 /**
- * Wait for the current search to terminate.
+ * Wait for the current search to terminate. Returns immediately
+ * if no search is active.
  */
 void waitForSearchTermination(void);
 
@@ -22,6 +22,7 @@
 
 #include <assert.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 #include "position.h"
 #include "fen.h"
@@ -33,13 +34,10 @@
 #endif
 
 #ifndef NDEBUG
-PawnHashInfo localPawnHashtable[PAWN_HASHTABLE_SIZE];
-KingSafetyHashInfo localKingSafetyHashtable[KINGSAFETY_HASHTABLE_SIZE];
+PawnHashtable localPawnHashtable;
+KingSafetyHashtable localKingSafetyHashtable;
 #endif
 
-KingSafetyHashInfo
-   kingSafetyHashtable[MAX_THREADS][KINGSAFETY_HASHTABLE_SIZE];
-
 #define MAX_MOVES_KNIGHT 8
 #define MAX_MOVES_BISHOP 13
 #define MAX_MOVES_ROOK 14
@@ -1614,15 +1612,19 @@ static int getSafetyMalusOfKingSquare(const Position * position,
 }
 
 static INT32 getPawnShelterMalus(const Position * position, const Color color,
-                                 KingSafetyHashInfo * kingSafetyHashtable)
+                                 KingSafetyHashtable * kingSafetyHashtable)
 {
    const Bitboard hashKey = calculateKingPawnSafetyHashKey(position, color);
    KingSafetyHashInfo *kingSafetyHashInfo =
-      &kingSafetyHashtable[hashKey & KINGSAFETY_HASHTABLE_MASK];
+      &kingSafetyHashtable->table[hashKey & kingSafetyHashtable->hashMask];
+
+   kingSafetyHashtable->lookups++;
 
    if (kingSafetyHashInfo->hashKey == hashKey &&
        kingSafetyHashInfo->hashKey != 0)
    {
+      kingSafetyHashtable->hits++;
+
       return kingSafetyHashInfo->safetyMalus;
    }
    else
@@ -1846,7 +1848,7 @@ static Bitboard randomBitboard()
 #endif
 
 static void initializeEvaluationBase(EvaluationBase * base,
-                                     KingSafetyHashInfo *
+                                     KingSafetyHashtable *
                                      kingsafetyHashtable,
                                      const Position * position)
 {
@@ -2347,17 +2349,20 @@ static void getPositionalValue(const Position * position,
 
 int getValue(const Position * position,
              EvaluationBase * base,
-             PawnHashInfo * pawnHashtable,
-             KingSafetyHashInfo * kingsafetyHashtable)
+             PawnHashtable * pawnHashtable,
+             KingSafetyHashtable * kingsafetyHashtable)
 {
    PawnHashInfo *pawnHashInfo =
-      &pawnHashtable[position->pawnHashKey & PAWN_HASHTABLE_MASK];
+      &pawnHashtable->table[position->pawnHashKey & pawnHashtable->hashMask];
 
    initializeEvaluationBase(base, kingsafetyHashtable, position);
+   pawnHashtable->lookups++;
 
    if (pawnHashInfo->hashKey == position->pawnHashKey &&
        pawnHashInfo->hashKey != 0)
    {
+      pawnHashtable->hits++;
+
 #ifndef NDEBUG
       getPawnInfo(position, base);
       evaluatePawns(position, base);
@@ -4079,10 +4084,108 @@ int initializeModuleEvaluation()
    return 0;
 }
 
+/**
+ * Allocate a cache line aligned table of 'size' bytes at most. The number
+ * of entries is a power of two.
+ */
+static void *allocateEvalHashtable(UINT64 size, size_t entrySize,
+                                   void **memory, UINT64 * tableSize)
+{
+   UINT64 numEntries = 1;
+
+   while (numEntries * 2 * entrySize <= size)
+   {
+      numEntries *= 2;
+   }
+
+   *tableSize = numEntries;
+   *memory = malloc(numEntries * entrySize + HASHTABLE_CACHE_LINE_SIZE);
+
+   if (*memory == 0)
+   {
+      logDebug("### Eval hashtable could not be allocated. ###\n");
+
+      exit(EXIT_FAILURE);
+   }
+
+   return (void *)
+      (((size_t) * memory + HASHTABLE_CACHE_LINE_SIZE - 1) &
+       ~((size_t) HASHTABLE_CACHE_LINE_SIZE - 1));
+}
+
+void initializePawnHashtable(PawnHashtable * hashtable)
+{
+   hashtable->table = 0;
+   hashtable->memory = 0;
+   hashtable->tableSize = hashtable->hashMask = 0;
+   hashtable->lookups = hashtable->hits = 0;
+}
+
+void setPawnHashtableSize(PawnHashtable * hashtable, UINT64 size)
+{
+   deletePawnHashtable(hashtable);
+   hashtable->table = allocateEvalHashtable(size, sizeof(PawnHashInfo),
+                                            &hashtable->memory,
+                                            &hashtable->tableSize);
+   hashtable->hashMask = hashtable->tableSize - 1;
+   resetPawnHashtable(hashtable);
+}
+
+void resetPawnHashtable(PawnHashtable * hashtable)
+{
+   if (hashtable->table != 0)
+   {
+      memset(hashtable->table, 0, hashtable->tableSize * sizeof(PawnHashInfo));
+   }
+
+   hashtable->lookups = hashtable->hits = 0;
+}
+
+void deletePawnHashtable(PawnHashtable * hashtable)
+{
+   free(hashtable->memory);
+   initializePawnHashtable(hashtable);
+}
+
+void initializeKingsafetyHashtable(KingSafetyHashtable * hashtable)
+{
+   hashtable->table = 0;
+   hashtable->memory = 0;
+   hashtable->tableSize = hashtable->hashMask = 0;
+   hashtable->lookups = hashtable->hits = 0;
+}
+
+void setKingsafetyHashtableSize(KingSafetyHashtable * hashtable, UINT64 size)
+{
+   deleteKingsafetyHashtable(hashtable);
+   hashtable->table =
+      allocateEvalHashtable(size, sizeof(KingSafetyHashInfo),
+                            &hashtable->memory, &hashtable->tableSize);
+   hashtable->hashMask = hashtable->tableSize - 1;
+   resetKingsafetyHashtable(hashtable);
+}
+
+void resetKingsafetyHashtable(KingSafetyHashtable * hashtable)
+{
+   if (hashtable->table != 0)
+   {
+      memset(hashtable->table, 0,
+             hashtable->tableSize * sizeof(KingSafetyHashInfo));
+   }
+
+   hashtable->lookups = hashtable->hits = 0;
+}
+
+void deleteKingsafetyHashtable(KingSafetyHashtable * hashtable)
+{
+   free(hashtable->memory);
+   initializeKingsafetyHashtable(hashtable);
+}
+
 #ifndef NDEBUG
 bool flipTest(Position * position,
-              PawnHashInfo * pawnHashtable,
-              KingSafetyHashInfo * kingsafetyHashtable)
+              PawnHashtable * pawnHashtable,
+              KingSafetyHashtable * kingsafetyHashtable)
 {
    int v1, v2;
    EvaluationBase base;
@@ -4323,27 +4426,6 @@ static int testKingPawnDistanceCalculation()
 }
 
 #ifndef NDEBUG
-static void initializePawnHashtable(PawnHashInfo * pawnHashtable)
-{
-   int i;
-
-   for (i = 0; i < PAWN_HASHTABLE_SIZE; i++)
-   {
-      pawnHashtable[i].hashKey = 0;
-   }
-}
-
-static void initializeKingsafetyHashtable(KingSafetyHashInfo *
-                                          kingsafetyHashtable)
-{
-   int i;
-
-   for (i = 0; i < KINGSAFETY_HASHTABLE_SIZE; i++)
-   {
-      kingsafetyHashtable[i].hashKey = 0;
-   }
-}
-
 static int testFlippings()
 {
    const char fen1[] =
@@ -4357,10 +4439,12 @@ static int testFlippings()
    Variation variation;
 
    initializeVariation(&variation, fen1);
-   variation.pawnHashtable = localPawnHashtable;
-   variation.kingsafetyHashtable = localKingSafetyHashtable;
+   variation.pawnHashtable = &localPawnHashtable;
+   variation.kingsafetyHashtable = &localKingSafetyHashtable;
    initializePawnHashtable(variation.pawnHashtable);
    initializeKingsafetyHashtable(variation.kingsafetyHashtable);
+   setPawnHashtableSize(variation.pawnHashtable, 1024 * 1024);
+   setKingsafetyHashtableSize(variation.kingsafetyHashtable, 1024 * 1024);
    assert(flipTest(&variation.singlePosition, variation.pawnHashtable,
                    variation.kingsafetyHashtable) != FALSE);
 
@@ -4382,6 +4466,54 @@ static int testFlippings()
 
    return 0;
 }
+
+static int testEvalHashtables()
+{
+   const char fen[] =
+      "2rr2k1/1b3ppp/pb2p3/1p2P3/1P2BPnq/P1N3P1/1B2Q2P/R4R1K b - - 0 1";
+   Variation variation;
+   EvaluationBase base;
+   int v1, v2;
+
+   initializeVariation(&variation, fen);
+   setPawnHashtableSize(&localPawnHashtable, 100000);
+   setKingsafetyHashtableSize(&localKingSafetyHashtable, 100000);
+   assert((localPawnHashtable.tableSize &
+           (localPawnHashtable.tableSize - 1)) == 0);
+   assert(localPawnHashtable.tableSize * sizeof(PawnHashInfo) <= 100000);
+   assert(2 * localPawnHashtable.tableSize * sizeof(PawnHashInfo) > 100000);
+   assert(localKingSafetyHashtable.hashMask ==
+          localKingSafetyHashtable.tableSize - 1);
+   assert(((size_t) localPawnHashtable.table &
+           (HASHTABLE_CACHE_LINE_SIZE - 1)) == 0);
+   assert(((size_t) localKingSafetyHashtable.table &
+           (HASHTABLE_CACHE_LINE_SIZE - 1)) == 0);
+
+   base.ownColor = WHITE;
+   v1 = getValue(&variation.singlePosition, &base, &localPawnHashtable,
+                 &localKingSafetyHashtable);
+   assert(localPawnHashtable.lookups == 1);
+   assert(localPawnHashtable.hits == 0);
+
+   v2 = getValue(&variation.singlePosition, &base, &localPawnHashtable,
+                 &localKingSafetyHashtable);
+   assert(v1 == v2);
+   assert(localPawnHashtable.lookups == 2);
+   assert(localPawnHashtable.hits == 1);
+   assert(localKingSafetyHashtable.hits <=
+          localKingSafetyHashtable.lookups);
+
+   resetPawnHashtable(&localPawnHashtable);
+   resetKingsafetyHashtable(&localKingSafetyHashtable);
+   assert(localPawnHashtable.lookups == 0);
+   assert(localKingSafetyHashtable.lookups == 0);
+
+   deletePawnHashtable(&localPawnHashtable);
+   deleteKingsafetyHashtable(&localKingSafetyHashtable);
+   assert(localPawnHashtable.table == 0);
+
+   return 0;
+}
 #endif
 
 int testModuleEvaluation()
@@ -4413,6 +4545,11 @@ int testModuleEvaluation()
    {
       return result;
    }
+
+   if ((result = testEvalHashtables()) != 0)
+   {
+      return result;
+   }
 #endif
 
    return 0;
@@ -81,8 +81,8 @@ INT32 positionalBalance(const Position * position, EvaluationBase * base);
 int basicPositionalBalance(Position * position);
 int getValue(const Position * position,
              EvaluationBase * base,
-             PawnHashInfo * pawnHashtable,
-             KingSafetyHashInfo * kingsafetyHashtable);
+             PawnHashtable * pawnHashtable,
+             KingSafetyHashtable * kingsafetyHashtable);
 bool hasWinningPotential(Position * position, Color color);
 Bitboard calculateKingPawnSafetyHashKey(const Position * position,
                                         const Color color);
@@ -102,8 +102,8 @@ double wmbv(const double baseValue);
  */
 int getValue(const Position * position,
              EvaluationBase * base,
-             PawnHashInfo * pawnHashtable,
-             KingSafetyHashInfo * kingsafetyHashtable);
+             PawnHashtable * pawnHashtable,
+             KingSafetyHashtable * kingsafetyHashtable);
 
 /**
  * Check if the pawn at the specified square is a passed pawn.
@@ -118,17 +118,56 @@ bool captureCreatesPasser(Position * position, const Square captureSquare,
                           const Piece capturingPiece);
 
 /**
- * Reset the pawn hashtable.
+ * Initialize the specified pawn hashtable. No memory is allocated.
  */
-void resetPawnHashtable(void);
+void initializePawnHashtable(PawnHashtable * hashtable);
+
+/**
+ * Allocate the specified pawn hashtable with at most 'size' bytes.
+ * The table is cleared by the calling thread.
+ */
+void setPawnHashtableSize(PawnHashtable * hashtable, UINT64 size);
+
+/**
+ * Clear the entries and the counters of the specified pawn hashtable.
+ */
+void resetPawnHashtable(PawnHashtable * hashtable);
+
+/**
+ * Release the memory of the specified pawn hashtable.
+ */
+void deletePawnHashtable(PawnHashtable * hashtable);
+
+/**
+ * Initialize the specified king safety hashtable. No memory is allocated.
+ */
+void initializeKingsafetyHashtable(KingSafetyHashtable * hashtable);
+
+/**
+ * Allocate the specified king safety hashtable with at most 'size' bytes.
+ * The table is cleared by the calling thread.
+ */
+void setKingsafetyHashtableSize(KingSafetyHashtable * hashtable,
+                                UINT64 size);
+
+/**
+ * Clear the entries and the counters of the specified king safety
+ * hashtable.
+ */
+void resetKingsafetyHashtable(KingSafetyHashtable * hashtable);
+
+/**
+ * Release the memory of the specified king safety hashtable.
+ */
+void deleteKingsafetyHashtable(KingSafetyHashtable * hashtable);
 
 /**
  * Flip the given position and check if it yields the same result.
  *
  * @return FALSE if the flipped position yields a diffent result
  */
-bool flipTest(Position * position, PawnHashInfo * pawnHashtable,
-              KingSafetyHashInfo * kingsafetyHashtable);
+bool flipTest(Position * position, PawnHashtable * pawnHashtable,
+              KingSafetyHashtable * kingsafetyHashtable);
 
 /**
  * Initialize this module.
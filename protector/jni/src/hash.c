@@ -27,13 +27,16 @@
 #include "io.h"
 #include "keytable.h"
 
-#define NODE_TABLE_SIZE (MAX_THREADS * MAX_DEPTH * 32)
+#define NODE_TABLE_SIZE 16384    /* buckets, must be a power of two */
+#define NODE_SIGNATURE_MASK 0xFFFFFFFFFFFF0000llu
+#define NODE_COUNT_MASK 0xFF
 
 const unsigned int NUM_DATES = 16;
 const unsigned int CLUSTER_SIZE = 4;
 const UINT8 DEPTH_NONE = 0;
-Nodeentry nodeUsageTable[NODE_TABLE_SIZE];
-long numNodeTableEntries;
+Nodeentry nodeUsageTable[NODE_TABLE_SIZE]
+__attribute__ ((aligned(HASHTABLE_CACHE_LINE_SIZE)));
+NodeUsageStatistics nodeUsageStatistics[MAX_THREADS];
 
 INT16 getHashentryValue(const Hashentry * entry)
 {
@@ -89,9 +92,10 @@ void incrementDate(Hashtable * hashtable)
 
 static void deleteTables(Hashtable * hashtable)
 {
-   if (hashtable->table != 0)
+   if (hashtable->memory != 0)
    {
-      free(hashtable->table);
+      free(hashtable->memory);
+      hashtable->memory = 0;
       hashtable->table = 0;
    }
 }
@@ -128,13 +132,13 @@ void resetHashtable(Hashtable * hashtable)
    emptyEntry.data = _getHashData(-VALUE_MATED, 0, DEPTH_NONE,
                                   (UINT16) NO_MOVE, 0, HASHVALUE_UPPER_LIMIT);
 
-   for (l = 0; l < hashtable->tableSize + CLUSTER_SIZE; l++)
+   for (l = 0; l < hashtable->tableSize; l++)
    {
       hashtable->table[l] = emptyEntry;
    }
 
    hashtable->date = 0;
-   hashtable->entriesUsed = 0;
+   resetHashtableUsage(hashtable);
 
    /* logDebug("hashtable reset done.\n"); */
 }
@@ -145,15 +149,71 @@ void resetNodetable(void)
 
    for (i = 0; i < NODE_TABLE_SIZE; i++)
    {
-      nodeUsageTable[i].key = ULONG_ZERO;
+      int j;
+
+      for (j = 0; j < NODE_BUCKET_SIZE; j++)
+      {
+         nodeUsageTable[i].slot[j] = ULONG_ZERO;
+      }
+   }
+}
+
+void resetNodeUsageStatistics(void)
+{
+   int i;
+
+   for (i = 0; i < MAX_THREADS; i++)
+   {
+      nodeUsageStatistics[i].deferrals = 0;
+      nodeUsageStatistics[i].claims = 0;
+      nodeUsageStatistics[i].bucketsFull = 0;
+   }
+}
+
+void getNodeUsageStatistics(NodeUsageStatistics * total)
+{
+   int i;
+
+   total->deferrals = total->claims = total->bucketsFull = 0;
+
+   for (i = 0; i < MAX_THREADS; i++)
+   {
+      total->deferrals += nodeUsageStatistics[i].deferrals;
+      total->claims += nodeUsageStatistics[i].claims;
+      total->bucketsFull += nodeUsageStatistics[i].bucketsFull;
    }
 }
 
 void initializeHashtable(Hashtable * hashtable)
 {
    hashtable->table = 0;
+   hashtable->memory = 0;
    hashtable->tableSize = 0;
-   hashtable->entriesUsed = 0;
+   hashtable->hashMask = 0;
+   resetHashtableUsage(hashtable);
+}
+
+void resetHashtableUsage(Hashtable * hashtable)
+{
+   int i;
+
+   for (i = 0; i < MAX_THREADS; i++)
+   {
+      hashtable->usage[i].entriesUsed = 0;
+   }
+}
+
+UINT64 getHashtableEntriesUsed(const Hashtable * hashtable)
+{
+   UINT64 sum = 0;
+   int i;
+
+   for (i = 0; i < MAX_THREADS; i++)
+   {
+      sum += hashtable->usage[i].entriesUsed;
+   }
+
+   return sum;
 }
 
 bool isPrimeNumber(UINT64 n)
@@ -205,14 +265,33 @@ UINT64 getPreviousPrime(UINT64 n)
    return n;
 }
 
+/**
+ * The table consists of a power of two number of entries. CLUSTER_SIZE
+ * entries form a cluster of exactly one cache line, and the table is
+ * aligned so that no cluster straddles two cache lines. This allows
+ * indexing by masking the key instead of a 64 bit division.
+ */
 void setHashtableSize(Hashtable * hashtable, UINT64 size)
 {
    const UINT64 ENTRY_SIZE = sizeof(Hashentry);
+   UINT64 numEntries = CLUSTER_SIZE;
+
+   assert(CLUSTER_SIZE * ENTRY_SIZE == HASHTABLE_CACHE_LINE_SIZE);
 
    deleteTables(hashtable);
-   hashtable->tableSize = getNextPrime(size / ENTRY_SIZE);
-   hashtable->table =
-      malloc((hashtable->tableSize + CLUSTER_SIZE) * ENTRY_SIZE);
+
+   while (numEntries * 2 * ENTRY_SIZE <= size)
+   {
+      numEntries *= 2;
+   }
+
+   hashtable->tableSize = numEntries;
+   hashtable->hashMask = numEntries - CLUSTER_SIZE;
+   hashtable->memory =
+      malloc(numEntries * ENTRY_SIZE + HASHTABLE_CACHE_LINE_SIZE);
+   hashtable->table = (Hashentry *)
+      (((size_t) hashtable->memory + HASHTABLE_CACHE_LINE_SIZE - 1) &
+       ~((size_t) HASHTABLE_CACHE_LINE_SIZE - 1));
 
    /* logDebug("Hashtable size: %ld entries\n",
       hashtable->tableSize); */
@@ -220,12 +299,17 @@ void setHashtableSize(Hashtable * hashtable, UINT64 size)
 
 UINT64 getHashIndex(Hashtable * hashtable, UINT64 key)
 {
-   return key % ((hashtable)->tableSize);
+   return key & hashtable->hashMask;
+}
+
+void prefetchHashentry(const Hashtable * hashtable, UINT64 key)
+{
+   PREFETCH(&hashtable->table[key & hashtable->hashMask]);
 }
 
 void setHashentry(Hashtable * hashtable, UINT64 key, INT16 value,
                   UINT8 importance, UINT16 bestMove, UINT8 flag,
-                  INT16 staticValue)
+                  INT16 staticValue, unsigned int threadNumber)
 {
    const UINT64 index = getHashIndex(hashtable, key);
    UINT64 data, i, bestEntry = 0;
@@ -241,7 +325,7 @@ void setHashentry(Hashtable * hashtable, UINT64 key, INT16 value,
       {
          if (copyDate != hashtable->date || copy.key == ULONG_ZERO)
          {
-            hashtable->entriesUsed++;
+            hashtable->usage[threadNumber].entriesUsed++;
          }
 
          if (bestMove == (UINT16) NO_MOVE)
@@ -274,7 +358,7 @@ void setHashentry(Hashtable * hashtable, UINT64 key, INT16 value,
    if (getHashentryDate(&hashtable->table[index + bestEntry]) !=
        hashtable->date)
    {
-      hashtable->entriesUsed++;
+      hashtable->usage[threadNumber].entriesUsed++;
    }
 
    entryToBeReplaced = &hashtable->table[index + bestEntry];
@@ -284,7 +368,8 @@ void setHashentry(Hashtable * hashtable, UINT64 key, INT16 value,
    entryToBeReplaced->data = data;
 }
 
-Hashentry *getHashentry(Hashtable * hashtable, UINT64 key)
+Hashentry *getHashentry(Hashtable * hashtable, UINT64 key,
+                        unsigned int threadNumber)
 {
    const UINT64 index = getHashIndex(hashtable, key);
    UINT64 i;
@@ -306,7 +391,7 @@ Hashentry *getHashentry(Hashtable * hashtable, UINT64 key)
 
             tableEntry->key = key ^ newData;
             tableEntry->data = newData;
-            hashtable->entriesUsed++;
+            hashtable->usage[threadNumber].entriesUsed++;
 
             assert(getHashentryValue(&originalEntry) ==
                    getHashentryValue(tableEntry));
@@ -328,47 +413,137 @@ Hashentry *getHashentry(Hashtable * hashtable, UINT64 key)
    return 0;
 }
 
-UINT64 getNodeIndex(UINT64 key)
+static Nodeentry *getNodeBucket(UINT64 key)
 {
-   return key % numNodeTableEntries;
+   return &nodeUsageTable[key & (NODE_TABLE_SIZE - 1)];
 }
 
-bool nodeIsInUse(UINT64 key, UINT8 depth)
+static UINT64 getNodeSignature(UINT64 key)
 {
-   UINT64 nodeIndex = getNodeIndex(key);
+   /* A zero signature would be indistinguishable from an empty slot. */
+   const UINT64 signature = key & NODE_SIGNATURE_MASK;
+
+   return (signature == ULONG_ZERO ? NODE_SIGNATURE_MASK : signature);
+}
 
-   return nodeUsageTable[nodeIndex].key == key &&
-      nodeUsageTable[nodeIndex].depth >= depth && key != ULONG_ZERO;
+static UINT8 getNodeDepth(UINT64 slot)
+{
+   return (UINT8) ((slot >> 8) & 0xFF);
 }
 
-bool setNodeUsage(UINT64 key, UINT8 depth)
+static unsigned int getNodeCount(UINT64 slot)
 {
-   UINT64 nodeIndex = getNodeIndex(key);
+   return (unsigned int) (slot & NODE_COUNT_MASK);
+}
 
-   if (nodeUsageTable[nodeIndex].key == ULONG_ZERO)
+bool nodeIsInUse(UINT64 key, UINT8 depth, unsigned int threadNumber)
+{
+   Nodeentry *bucket = getNodeBucket(key);
+   const UINT64 signature = getNodeSignature(key);
+   int i;
+
+   for (i = 0; i < NODE_BUCKET_SIZE; i++)
    {
-      nodeUsageTable[nodeIndex].key = key;
-      nodeUsageTable[nodeIndex].depth = depth;
+      const UINT64 slot = bucket->slot[i];
 
-      return TRUE;
+      if ((slot & NODE_SIGNATURE_MASK) == signature &&
+          getNodeCount(slot) > 0 && getNodeDepth(slot) >= depth)
+      {
+         nodeUsageStatistics[threadNumber].deferrals++;
+
+         return TRUE;
+      }
    }
-   else
+
+   return FALSE;
+}
+
+bool setNodeUsage(UINT64 key, UINT8 depth, unsigned int threadNumber)
+{
+   Nodeentry *bucket = getNodeBucket(key);
+   const UINT64 signature = getNodeSignature(key);
+   int i;
+
+ retry:
+
+   /* Join a claim another thread already holds for this node. */
+   for (i = 0; i < NODE_BUCKET_SIZE; i++)
    {
-      return FALSE;
+      const UINT64 slot = bucket->slot[i];
+
+      if ((slot & NODE_SIGNATURE_MASK) == signature)
+      {
+         const UINT8 newDepth =
+            (getNodeDepth(slot) > depth ? getNodeDepth(slot) : depth);
+         const UINT64 newSlot = signature | ((UINT64) newDepth << 8) |
+            (getNodeCount(slot) + 1);
+
+         if (__sync_bool_compare_and_swap(&bucket->slot[i], slot, newSlot))
+         {
+            nodeUsageStatistics[threadNumber].claims++;
+
+            return TRUE;
+         }
+
+         goto retry;
+      }
+   }
+
+   /* Otherwise take the first free slot of the bucket. */
+   for (i = 0; i < NODE_BUCKET_SIZE; i++)
+   {
+      if (bucket->slot[i] == ULONG_ZERO)
+      {
+         const UINT64 newSlot = signature | ((UINT64) depth << 8) | 1;
+
+         if (__sync_bool_compare_and_swap(&bucket->slot[i], ULONG_ZERO,
+                                          newSlot))
+         {
+            nodeUsageStatistics[threadNumber].claims++;
+
+            return TRUE;
+         }
+
+         goto retry;            /* the slot might now hold this very node */
+      }
    }
+
+   nodeUsageStatistics[threadNumber].bucketsFull++;
+
+   return FALSE;
 }
 
 void resetNodeUsage(UINT64 key, UINT8 depth)
 {
-   UINT64 nodeIndex = getNodeIndex(key);
+   Nodeentry *bucket = getNodeBucket(key);
+   const UINT64 signature = getNodeSignature(key);
+   int i;
+
+   for (i = 0; i < NODE_BUCKET_SIZE; i++)
+   {
+      UINT64 slot = bucket->slot[i];
+
+      while ((slot & NODE_SIGNATURE_MASK) == signature)
+      {
+         const UINT64 newSlot =
+            (getNodeCount(slot) > 1 ? slot - 1 : ULONG_ZERO);
+         const UINT64 previous =
+            __sync_val_compare_and_swap(&bucket->slot[i], slot, newSlot);
 
-   nodeUsageTable[nodeIndex].key = ULONG_ZERO;
+         if (previous == slot)
+         {
+            return;
+         }
+
+         slot = previous;
+      }
+   }
 }
 
 int initializeModuleHash(void)
 {
    resetNodetable();
-   numNodeTableEntries = getPreviousPrime(NODE_TABLE_SIZE);
+   resetNodeUsageStatistics();
 
    return 0;
 }
@@ -395,6 +570,93 @@ static int testAgeCalculation(void)
    return (hashtable.date == (UINT8) (NUM_DATES - 1) ? 0 : 1);
 }
 
+static int testClusterIndexing(void)
+{
+   Hashtable hashtable;
+   UINT64 key = 0xfedcba9876543210ull;
+   Hashentry *entry;
+   int i;
+
+   initializeHashtable(&hashtable);
+   setHashtableSize(&hashtable, 1000 * 1000);
+   resetHashtable(&hashtable);
+
+   assert(hashtable.tableSize == 32768);
+   assert(((size_t) hashtable.table & (HASHTABLE_CACHE_LINE_SIZE - 1)) == 0);
+
+   for (i = 0; i < 1000; i++, key = key * 6364136223846793005ull + 1)
+   {
+      assert(getHashIndex(&hashtable, key) % CLUSTER_SIZE == 0);
+      assert(getHashIndex(&hashtable, key) + CLUSTER_SIZE <=
+             hashtable.tableSize);
+   }
+
+   setHashentry(&hashtable, key, 17, 3, (UINT16) NO_MOVE,
+                HASHVALUE_EXACT, 5, 1);
+   entry = getHashentry(&hashtable, key, 2);
+   assert(entry != 0);
+   assert(getHashentryValue(entry) == 17);
+   assert(hashtable.usage[1].entriesUsed == 1);
+   assert(getHashtableEntriesUsed(&hashtable) == 1);
+
+   deleteTables(&hashtable);
+
+   return (entry != 0 ? 0 : 1);
+}
+
+static int testNodeUsage(void)
+{
+   const UINT64 key = 0xfedcba9876543210ull;
+   NodeUsageStatistics statistics;
+   bool inUse, claimed;
+   int i;
+
+   resetNodetable();
+   resetNodeUsageStatistics();
+
+   inUse = nodeIsInUse(key, 12, 0);
+   assert(inUse == FALSE);
+   claimed = setNodeUsage(key, 12, 0);
+   assert(claimed);
+   inUse = nodeIsInUse(key, 12, 1);
+   assert(inUse);
+   inUse = nodeIsInUse(key, 14, 1);
+   assert(inUse == FALSE);
+   claimed = setNodeUsage(key, 14, 1);
+   assert(claimed);
+   inUse = nodeIsInUse(key, 14, 2);
+   assert(inUse);
+
+   /* The node stays claimed until the last thread has released it. */
+   resetNodeUsage(key, 12);
+   inUse = nodeIsInUse(key, 14, 2);
+   assert(inUse);
+   resetNodeUsage(key, 14);
+   inUse = nodeIsInUse(key, 12, 2);
+   assert(inUse == FALSE);
+
+   /* Keys sharing a bucket fill it up to its associativity. */
+   for (i = 0; i < NODE_BUCKET_SIZE; i++)
+   {
+      claimed = setNodeUsage(key + ((UINT64) (i + 1) << 32), 12, 0);
+      assert(claimed);
+   }
+
+   claimed = setNodeUsage(key, 12, 0);
+   assert(claimed == FALSE);
+
+   getNodeUsageStatistics(&statistics);
+   assert(statistics.deferrals == 3);
+   assert(statistics.claims == 2 + NODE_BUCKET_SIZE);
+   assert(statistics.bucketsFull == 1);
+
+   resetNodetable();
+   resetNodeUsageStatistics();
+
+   return (statistics.bucketsFull == 1 && inUse == FALSE &&
+           claimed == FALSE ? 0 : 1);
+}
+
 int testModuleHash(void)
 {
    int result = 0;
@@ -404,5 +666,15 @@ int testModuleHash(void)
       return result;
    }
 
+   if ((result = testClusterIndexing()) != 0)
+   {
+      return result;
+   }
+
+   if ((result = testNodeUsage()) != 0)
+   {
+      return result;
+   }
+
    return 0;
 }
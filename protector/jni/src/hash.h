@@ -43,6 +43,28 @@ UINT64 getNextPrime(UINT64 n);
 UINT64 getPreviousPrime(UINT64 n);
 UINT64 getHashIndex(Hashtable * hashtable, UINT64 key);
 
+#ifdef __GNUC__
+#define PREFETCH(address) __builtin_prefetch(address)
+#else
+#define PREFETCH(address)
+#endif
+
+/**
+ * Prefetch the cluster of the specified key into the cpu cache.
+ */
+void prefetchHashentry(const Hashtable * hashtable, UINT64 key);
+
+/**
+ * Get the number of entries used in the current search, summed up
+ * over the per-thread counters.
+ */
+UINT64 getHashtableEntriesUsed(const Hashtable * hashtable);
+
+/**
+ * Reset the per-thread usage counters of the specified hashtable.
+ */
+void resetHashtableUsage(Hashtable * hashtable);
+
 /**
  * Reset the specified hashtable. Call this function in order to
  * erase all stored data.
@@ -66,13 +88,13 @@ Hashentry constructHashEntry(UINT64 key, INT16 value, INT16 staticValue,
  */
 void setHashentry(Hashtable * hashtable, UINT64 key, INT16 value,
                   UINT8 importance, UINT16 bestMove, UINT8 flag,
-                  INT16 staticValue);
+                  INT16 staticValue, unsigned int threadNumber);
 
 /**
  * Get the entry specified by key.
  */
-Hashentry *getHashentry(Hashtable * hashtable, UINT64 key);
-UINT64 getNodeIndex(UINT64 key);
+Hashentry *getHashentry(Hashtable * hashtable, UINT64 key,
+                        unsigned int threadNumber);
 
 INT16 getHashentryValue(const Hashentry * entry);
 
@@ -82,10 +104,35 @@ UINT8 getHashentryDate(const Hashentry * entry);
 UINT8 getHashentryFlag(const Hashentry * entry);
 UINT64 getHashentryKey(const Hashentry * entry);
 INT16 getHashentryStaticValue(const Hashentry * entry);
-bool nodeIsInUse(UINT64 key, UINT8 depth);
-bool setNodeUsage(UINT64 key, UINT8 depth);
+
+/**
+ * Check if another thread is searching the specified node at
+ * least as deep. A positive answer is counted as a deferral.
+ */
+bool nodeIsInUse(UINT64 key, UINT8 depth, unsigned int threadNumber);
+
+/**
+ * Register the calling thread as searching the specified node.
+ *
+ * @return FALSE if the node's bucket was full and no claim was made.
+ */
+bool setNodeUsage(UINT64 key, UINT8 depth, unsigned int threadNumber);
+
+/**
+ * Release a claim made by setNodeUsage.
+ */
 void resetNodeUsage(UINT64 key, UINT8 depth);
 
+/**
+ * Reset the deferral and claim counters of the node usage table.
+ */
+void resetNodeUsageStatistics(void);
+
+/**
+ * Sum up the node usage counters of all threads.
+ */
+void getNodeUsageStatistics(NodeUsageStatistics * total);
+
 /**
  * Initialize this module.
  *
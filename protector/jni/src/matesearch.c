@@ -21,6 +21,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <assert.h>
+#include <pthread.h>
 #include "matesearch.h"
 #include "io.h"
 #include "movegeneration.h"
@@ -62,8 +63,9 @@ static int searchMate(Variation * variation, int alpha, int beta,
 
    /* Probe the transposition table */
    /* ----------------------------- */
-   tableHit = getHashentry(getSharedHashtable(),
-                           variation->singlePosition.hashKey);
+   tableHit = getHashentry(variation->hashtable,
+                           variation->singlePosition.hashKey,
+                           variation->threadNumber);
 
    if (tableHit != NULL)
    {
@@ -265,147 +267,295 @@ static int searchMate(Variation * variation, int alpha, int beta,
       hashentryFlag = HASHVALUE_UPPER_LIMIT;
    }
 
-   setHashentry(getSharedHashtable(), position->hashKey,
+   setHashentry(variation->hashtable, position->hashKey,
                 calcHashtableValue(best, ply), (INT8) restDepth,
-                packedMove(bestMove), hashentryFlag, 0);
+                packedMove(bestMove), hashentryFlag, 0,
+                variation->threadNumber);
 
    return best;
 }
 
-static int searchBaseMoves(Variation * variation, const int alpha,
-                           const int beta, const int restDepth,
-                           Movelist * solutions)
+/* The mate search is split into work items, one for every pair of base
+ * move and legal reply. Any thread takes the next item from the list, so
+ * base moves are searched in parallel as well as the replies to a single
+ * base move. An item that refutes its base move cuts off the remaining
+ * replies of that move. */
+
+void initializeMateSearch(MateSearch * mateSearch)
 {
-   Position *position = &variation->singlePosition;
-   const bool check = activeKingIsSafe(position) == FALSE;
-   int best = VALUE_MATED, ply = 0;
-   Movelist movelist;
-   Move hashmove = NO_MOVE;
-   Move currentMove;
-   PrincipalVariation pv;
+   pthread_mutex_init(&mateSearch->mutex, NULL);
+   pthread_cond_init(&mateSearch->condition, NULL);
+   mateSearch->barrierGeneration = 0;
+   resetMateSearch(mateSearch, 1);
+}
 
-   if (restDepth == 1)
+void resetMateSearch(MateSearch * mateSearch, int numThreads)
+{
+   mateSearch->numBaseMoves = mateSearch->numItems = 0;
+   mateSearch->numThreads = numThreads;
+   mateSearch->nextItem = 0;
+   mateSearch->aborted = FALSE;
+   mateSearch->barrierCount = 0;
+}
+
+static void waitForMateThreads(MateSearch * mateSearch)
+{
+   pthread_mutex_lock(&mateSearch->mutex);
+
+   if (++mateSearch->barrierCount == (unsigned int) mateSearch->numThreads)
    {
-      initCheckMovelist(&movelist, position, &variation->historyValue[0]);
+      mateSearch->barrierCount = 0;
+      mateSearch->barrierGeneration++;
+      pthread_cond_broadcast(&mateSearch->condition);
    }
    else
    {
-      movelist.positionalGain = &(variation->positionalGain[0]);
-      initStandardMovelist(&movelist, &variation->singlePosition,
-                           &variation->plyInfo[ply],
-                           &variation->historyValue[0], hashmove, check);
+      const unsigned int generation = mateSearch->barrierGeneration;
+
+      while (generation == mateSearch->barrierGeneration)
+      {
+         pthread_cond_wait(&mateSearch->condition, &mateSearch->mutex);
+      }
    }
 
+   pthread_mutex_unlock(&mateSearch->mutex);
+}
+
+static void reportSolution(Variation * variation, MateBaseMove * baseMove)
+{
+   variation->bestBaseMove = baseMove->move;
+   variation->pv[0] = baseMove->pv;
+   variation->pv[0].score = baseMove->score;
+
+   getGuiSearchMutex();
+   handleSearchEvent(SEARCHEVENT_NEW_PV, variation);
+   releaseGuiSearchMutex();
+}
+
+/**
+ * Build the work items. Base moves without a legal reply are
+ * resolved right away: they either mate in one or stalemate.
+ */
+static void prepareMateItems(Variation * variation, MateSearch * mateSearch)
+{
+   Position *position = &variation->singlePosition;
+   Movelist legalMoves;
+   int i;
+
+   mateSearch->numItems = 0;
+   getLegalMoves(variation, &legalMoves);
+   mateSearch->numBaseMoves = legalMoves.numberOfMoves;
    initializePlyInfo(variation);
 
-   while ((currentMove = getNextMove(&movelist)) != NO_MOVE)
+   for (i = 0; i < mateSearch->numBaseMoves; i++)
    {
-      int value;
+      MateBaseMove *baseMove = &mateSearch->baseMoves[i];
+      Movelist replies;
+      int j;
+
+      baseMove->move = legalMoves.moves[i];
+      baseMove->solved = baseMove->refuted = FALSE;
+      baseMove->pv.length = 0;
 
+      makeMoveFast(variation, baseMove->move);
       variation->nodes++;
+      getLegalMoves(variation, &replies);
+      baseMove->numReplies = replies.numberOfMoves;
 
-      if (makeMoveFast(variation, currentMove) != 0 ||
-          passiveKingIsSafe(&variation->singlePosition) == FALSE ||
-          (restDepth == 1 && activeKingIsSafe(&variation->singlePosition)))
+      for (j = 0; j < replies.numberOfMoves; j++)
       {
-         unmakeLastMove(variation);
+         MateItem *item = &mateSearch->items[mateSearch->numItems++];
 
-         continue;
+         item->baseMoveIndex = (UINT8) i;
+         item->reply = replies.moves[j];
       }
 
-      value =
-         -searchMate(variation, -beta, -alpha, ply + 1, restDepth - 1, &pv);
+      if (replies.numberOfMoves == 0 &&
+          activeKingIsSafe(position) == FALSE)
+      {
+         baseMove->solved = TRUE;
+         baseMove->score = -(VALUE_MATED + 1);
+         appendMoveToPv(&baseMove->pv, &baseMove->pv, baseMove->move);
+      }
 
       unmakeLastMove(variation);
 
-      if (value >= best)
+      if (baseMove->solved)
       {
-         best = variation->pv[0].score = value;
-         setMoveValue(&currentMove, value);
-         appendMoveToPv(&pv, &variation->pv[0], currentMove);
-
-         if (best > alpha)
-         {
-            variation->bestBaseMove = currentMove;
-            solutions->moves[solutions->numberOfMoves++] = currentMove;
-
-            if (variation->threadNumber == 0)
-            {
-               getGuiSearchMutex();
-               handleSearchEvent(SEARCHEVENT_NEW_PV, variation);
-               releaseGuiSearchMutex();
-            }
-         }
+         reportSolution(variation, baseMove);
       }
    }
+}
 
-   if (best == VALUE_MATED)
+/**
+ * Check if the attacker mates within restDepth plies after each
+ * base move and reply still open in the current iteration.
+ */
+static void searchMateItems(Variation * variation, MateSearch * mateSearch,
+                            const int restDepth)
+{
+   const int beta = -VALUE_MATED - restDepth;
+   int index;
+
+   while ((index = __sync_fetch_and_add(&mateSearch->nextItem, 1)) <
+          mateSearch->numItems)
    {
-      if (check)
+      const MateItem *item = &mateSearch->items[index];
+      MateBaseMove *baseMove =
+         &mateSearch->baseMoves[item->baseMoveIndex];
+      PrincipalVariation pv, replyPv;
+      int value;
+
+      if (variation->terminate)
       {
-         /* mate */
+         mateSearch->aborted = TRUE;
+         break;
+      }
 
-         best = VALUE_MATED + ply;
+      if (baseMove->solved || baseMove->refuted)
+      {
+         continue;
+      }
+
+      makeMoveFast(variation, baseMove->move);
+      initializePlyInfo(variation);
+      makeMoveFast(variation, item->reply);
+      variation->nodes += 2;
+      value = searchMate(variation, beta - 1, beta, 2, restDepth - 2, &pv);
+      unmakeLastMove(variation);
+      unmakeLastMove(variation);
+
+      if (value < beta)
+      {
+         baseMove->refuted = TRUE;
       }
       else
       {
-         /* stalemate */
+         pthread_mutex_lock(&mateSearch->mutex);
 
-         best = variation->drawScore[position->activeColor];
+         /* Keep the line of the longest defence. */
+         if (value < baseMove->score)
+         {
+            baseMove->score = value;
+            appendMoveToPv(&pv, &replyPv, item->reply);
+            appendMoveToPv(&replyPv, &baseMove->pv, baseMove->move);
+         }
+
+         pthread_mutex_unlock(&mateSearch->mutex);
       }
    }
+}
 
-   return best;
+/**
+ * Mark the base moves none of whose replies were refuted as solved
+ * and prepare the next iteration.
+ */
+static void finishMateIteration(Variation * variation,
+                                MateSearch * mateSearch)
+{
+   int i;
+
+   for (i = 0; i < mateSearch->numBaseMoves; i++)
+   {
+      MateBaseMove *baseMove = &mateSearch->baseMoves[i];
+
+      if (baseMove->solved == FALSE && baseMove->numReplies > 0)
+      {
+         if (baseMove->refuted == FALSE && mateSearch->aborted == FALSE &&
+             variation->iteration > 1)
+         {
+            baseMove->solved = TRUE;
+            reportSolution(variation, baseMove);
+         }
+
+         baseMove->refuted = FALSE;
+         baseMove->score = -VALUE_MATED;
+      }
+   }
+
+   mateSearch->nextItem = 0;
 }
 
-void searchForMate(Variation * variation, Movelist * foundSolutions,
-                   int numMoves)
+void searchForMate(Variation * variation, MateSearch * mateSearch,
+                   Movelist * foundSolutions, int numMoves)
 {
-   int numSolutions = 0, i;
+   int i, j;
 
    variation->startTime = getTimestamp();
    variation->startTimeProcess = getProcessTimestamp();
    variation->timestamp = variation->startTime + 1;
-   resetHashtable(getSharedHashtable());
-   getLegalMoves(variation, foundSolutions);
-   variation->numberOfBaseMoves = foundSolutions->numberOfMoves;
    variation->searchStatus = SEARCH_STATUS_RUNNING;
-
-   foundSolutions->numberOfMoves = 0;
+   variation->iteration = 1;
    resetHistoryValues(variation);
 
-   for (variation->iteration = 1; variation->iteration <= numMoves;
-        variation->iteration++)
+   for (i = 0; i < 2; i++)
    {
-      const int restDepth = 2 * variation->iteration - 1;
-      const int beta = -VALUE_MATED - restDepth;
+      variation->plyInfo[i].killerMove1 = NO_MOVE;
+      variation->plyInfo[i].killerMove2 = NO_MOVE;
+   }
 
-      searchBaseMoves(variation, beta - 1, beta, restDepth, foundSolutions);
+   initializePlyInfo(variation);
+
+   if (variation->threadNumber == 0)
+   {
+      resetHashtable(variation->hashtable);
+      prepareMateItems(variation, mateSearch);
+      finishMateIteration(variation, mateSearch);
    }
 
-   variation->finishTime = getTimestamp();
-   variation->finishTimeProcess = getProcessTimestamp();
-   variation->searchStatus = SEARCH_STATUS_TERMINATE;
+   waitForMateThreads(mateSearch);
+   variation->numberOfBaseMoves = mateSearch->numBaseMoves;
 
-   for (i = 0; i < foundSolutions->numberOfMoves; i++)
+   for (variation->iteration = 2; variation->iteration <= numMoves &&
+        mateSearch->aborted == FALSE; variation->iteration++)
    {
-      if (getMoveValue(foundSolutions->moves[i]) >=
-          -VALUE_MATED - 2 * numMoves + 1)
+      searchMateItems(variation, mateSearch, 2 * variation->iteration - 1);
+      waitForMateThreads(mateSearch);
+
+      if (variation->threadNumber == 0)
       {
-         numSolutions++;
+         finishMateIteration(variation, mateSearch);
       }
+
+      waitForMateThreads(mateSearch);
    }
 
-   foundSolutions->numberOfMoves = numSolutions;
+   variation->finishTime = getTimestamp();
+   variation->finishTimeProcess = getProcessTimestamp();
+   variation->searchStatus = SEARCH_STATUS_TERMINATE;
+
+   if (variation->threadNumber != 0)
+   {
+      return;
+   }
 
-   getGuiSearchMutex();
+   /* List the solutions with the shortest mates first. */
+   foundSolutions->numberOfMoves = 0;
 
-   if (variation->threadNumber == 0 &&
-       variation->searchStatus == SEARCH_STATUS_TERMINATE)
+   for (i = 0; i < mateSearch->numBaseMoves; i++)
    {
-      handleSearchEvent(SEARCHEVENT_SEARCH_FINISHED, variation);
+      const MateBaseMove *baseMove = &mateSearch->baseMoves[i];
+
+      if (baseMove->solved)
+      {
+         Move move = baseMove->move;
+
+         setMoveValue(&move, baseMove->score);
+
+         for (j = foundSolutions->numberOfMoves;
+              j > 0 && getMoveValue(foundSolutions->moves[j - 1]) <
+              baseMove->score; j--)
+         {
+            foundSolutions->moves[j] = foundSolutions->moves[j - 1];
+         }
+
+         foundSolutions->moves[j] = move;
+         foundSolutions->numberOfMoves++;
+      }
    }
 
+   getGuiSearchMutex();
+   handleSearchEvent(SEARCHEVENT_SEARCH_FINISHED, variation);
    releaseGuiSearchMutex();
 }
 
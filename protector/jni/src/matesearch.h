@@ -24,14 +24,65 @@
 #include "protector.h"
 #include "position.h"
 #include "movegeneration.h"
+#include <pthread.h>
+
+#define MAX_MATE_ITEMS (MAX_MOVES_PER_POSITION * MAX_MOVES_PER_POSITION)
+
+typedef struct
+{
+   Move move;
+   int numReplies, score;
+   volatile bool solved, refuted;
+   PrincipalVariation pv;
+}
+MateBaseMove;
+
+typedef struct
+{
+   UINT8 baseMoveIndex;
+   Move reply;
+}
+MateItem;
+
+/**
+ * The state of a mate search shared by all threads solving the
+ * same problem.
+ */
+typedef struct
+{
+   MateBaseMove baseMoves[MAX_MOVES_PER_POSITION];
+   MateItem items[MAX_MATE_ITEMS];
+   int numBaseMoves, numItems, numThreads;
+   volatile int nextItem;
+   volatile bool aborted;
+   unsigned int barrierCount, barrierGeneration;
+   pthread_mutex_t mutex;
+   pthread_cond_t condition;
+}
+MateSearch;
+
+/**
+ * Initialize the synchronization objects of the specified mate search.
+ */
+void initializeMateSearch(MateSearch * mateSearch);
+
+/**
+ * Prepare the specified mate search for a new problem. This must be
+ * done before any thread enters searchForMate.
+ *
+ * @param numThreads the number of threads solving the problem
+ */
+void resetMateSearch(MateSearch * mateSearch, int numThreads);
 
 /**
  * Solve the mate problem specified by variation.
  *
+ * @param mateSearch the state shared by all solving threads
  * @param movelist contains all solutions found
  * @param numMoves the maximum number of moves until the winner mates
  */
-void searchForMate(Variation * variation, Movelist * movelist, int numMoves);
+void searchForMate(Variation * variation, MateSearch * mateSearch,
+                   Movelist * movelist, int numMoves);
 
 /**
  * Initialize this module.
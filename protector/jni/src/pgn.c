@@ -18,10 +18,23 @@
 
 */
 
+#if __STDC_VERSION__ >= 199901L
+#define _XOPEN_SOURCE 600
+#else
+#define _XOPEN_SOURCE 500
+#endif /* __STDC_VERSION__ */
+
 #include <assert.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef TARGET_LINUX
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 #include "io.h"
 #include "pgn.h"
 #include "bitboard.h"
@@ -29,8 +42,8 @@
 #include "movegeneration.h"
 #include "fen.h"
 
-#define BUFSIZE 8192
 #define INCREMENT 1024
+#define PGN_INDEX_MAGIC 0x50474e49
 
 #define STATE_INIT	0
 #define STATE_1		1
@@ -39,6 +52,13 @@
 
 static char pieceName[16];
 
+typedef struct
+{
+   UINT32 magic, offsetSize;
+   INT64 fileSize, modificationTime, numGames;
+}
+PGNIndexHeader;
+
 /*
  ******************************************************************************
  *
@@ -47,9 +67,10 @@ static char pieceName[16];
  ******************************************************************************
  */
 
-static int scanForIndex(PGNFile * pgnfile, int state, char buffer[],
-                        size_t bufsize, size_t offset)
+static void scanForIndex(PGNFile * pgnfile, const char buffer[],
+                         size_t bufsize)
 {
+   int state = STATE_2;
    size_t i = 0;
 
    while (i < bufsize)
@@ -101,13 +122,13 @@ static int scanForIndex(PGNFile * pgnfile, int state, char buffer[],
          {
             if (pgnfile->numGames + 1 == pgnfile->indexSize)
             {
-               pgnfile->indexSize += INCREMENT;
+               pgnfile->indexSize += pgnfile->indexSize / 2 + INCREMENT;
                pgnfile->index = (long *) realloc(pgnfile->index,
                                                  pgnfile->indexSize *
                                                  sizeof(long));
             }
 
-            pgnfile->index[pgnfile->numGames++] = (long) (i + offset - 1L);
+            pgnfile->index[pgnfile->numGames++] = (long) (i - 1L);
             assert(pgnfile->numGames < pgnfile->indexSize);
          }
 
@@ -121,48 +142,191 @@ static int scanForIndex(PGNFile * pgnfile, int state, char buffer[],
          }
       }
    }
-
-   return state;
 }
 
 static void buildIndex(PGNFile * pgnfile)
 {
-   char buffer[BUFSIZE];
-   int state = STATE_2;
-   size_t numRead;
+   scanForIndex(pgnfile, pgnfile->data, (size_t) pgnfile->fileSize);
+   pgnfile->index[pgnfile->numGames] = pgnfile->fileSize + 1;
+}
+
+static char *getIndexfileName(const char *filename)
+{
+   char *indexfileName =
+      malloc(strlen(filename) + strlen(PGN_INDEX_EXTENSION) + 1);
+
+   if (indexfileName != 0)
+   {
+      strcpy(indexfileName, filename);
+      strcat(indexfileName, PGN_INDEX_EXTENSION);
+   }
+
+   return indexfileName;
+}
+
+static bool loadIndex(PGNFile * pgnfile, const char *indexfileName,
+                      const struct stat *pgnStatus)
+{
+   PGNIndexHeader header;
+   bool result = FALSE;
+   FILE *indexFile = fopen(indexfileName, "rb");
+
+   if (indexFile == 0)
+   {
+      return FALSE;
+   }
+
+   if (fread(&header, sizeof(header), 1, indexFile) == 1 &&
+       header.magic == PGN_INDEX_MAGIC &&
+       header.offsetSize == sizeof(long) &&
+       header.fileSize == (INT64) pgnStatus->st_size &&
+       header.modificationTime == (INT64) pgnStatus->st_mtime &&
+       header.numGames >= 0)
+   {
+      const long numOffsets = (long) header.numGames + 1;
+      long *index = (long *) realloc(pgnfile->index,
+                                     (numOffsets + 1) * sizeof(long));
+
+      if (index != 0)
+      {
+         pgnfile->index = index;
+         pgnfile->indexSize = numOffsets + 1;
+
+         if (fread(index, sizeof(long), numOffsets, indexFile) ==
+             (size_t) numOffsets)
+         {
+            pgnfile->numGames = (long) header.numGames;
+            result = TRUE;
+         }
+      }
+   }
+
+   fclose(indexFile);
+
+   return result;
+}
+
+static void saveIndex(const PGNFile * pgnfile, const char *indexfileName,
+                      const struct stat *pgnStatus)
+{
+   PGNIndexHeader header;
+   FILE *indexFile = fopen(indexfileName, "wb");
+   bool written;
+
+   if (indexFile == 0)
+   {
+      return;                   /* the index is simply rebuilt next time */
+   }
+
+   header.magic = PGN_INDEX_MAGIC;
+   header.offsetSize = sizeof(long);
+   header.fileSize = (INT64) pgnStatus->st_size;
+   header.modificationTime = (INT64) pgnStatus->st_mtime;
+   header.numGames = pgnfile->numGames;
+
+   written = (fwrite(&header, sizeof(header), 1, indexFile) == 1 &&
+              fwrite(pgnfile->index, sizeof(long), pgnfile->numGames + 1,
+                     indexFile) == (size_t) pgnfile->numGames + 1);
+   fclose(indexFile);
+
+   if (written == FALSE)
+   {
+      remove(indexfileName);
+   }
+}
+
+static int loadPGNData(PGNFile * pgnfile, const char *filename)
+{
+   FILE *file;
+   size_t numRead = 0;
+
+   if (pgnfile->fileSize == 0)
+   {
+      return 0;
+   }
+
+#ifdef TARGET_LINUX
+   {
+      const int fd = open(filename, O_RDONLY);
+      void *data;
+
+      if (fd < 0)
+      {
+         return -1;
+      }
+
+      data = mmap(0, (size_t) pgnfile->fileSize, PROT_READ, MAP_PRIVATE,
+                  fd, 0);
+      close(fd);
+
+      if (data != MAP_FAILED)
+      {
+         posix_madvise(data, (size_t) pgnfile->fileSize,
+                       POSIX_MADV_SEQUENTIAL);
+         pgnfile->data = data;
+         pgnfile->mapped = TRUE;
 
-   rewind(pgnfile->file);
+         return 0;
+      }
+   }
+#endif
 
-   do
+   if ((file = fopen(filename, "rb")) == 0)
    {
-      long pos = ftell(pgnfile->file);
+      return -1;
+   }
 
-      numRead = fread(buffer, 1, BUFSIZE, pgnfile->file);
-      state = scanForIndex(pgnfile, state, buffer, numRead, pos);
+   if ((pgnfile->data = malloc(pgnfile->fileSize)) != 0)
+   {
+      numRead = fread(pgnfile->data, 1, pgnfile->fileSize, file);
    }
-   while (numRead == BUFSIZE);
 
-   fseek(pgnfile->file, 0, SEEK_END);
-   pgnfile->index[pgnfile->numGames] = ftell(pgnfile->file) + 1;
+   fclose(file);
+
+   return (numRead == (size_t) pgnfile->fileSize ? 0 : -1);
 }
 
 int openPGNFile(PGNFile * pgnfile, const char *filename)
 {
-   pgnfile->index = (long *) malloc(INCREMENT * sizeof(long));
+   struct stat pgnStatus;
+   char *indexfileName;
 
+   pgnfile->index = (long *) malloc(INCREMENT * sizeof(long));
    pgnfile->indexSize = INCREMENT;
    pgnfile->numGames = 0;
-   pgnfile->file = fopen(filename, "rb");
+   pgnfile->data = 0;
+   pgnfile->fileSize = 0;
+   pgnfile->mapped = FALSE;
 
-   if (pgnfile->index != 0 && pgnfile->file != 0)
+   if (pgnfile->index == 0 || stat(filename, &pgnStatus) != 0)
    {
-      buildIndex(pgnfile);
-      return 0;
+      return -1;
    }
-   else
+
+   pgnfile->fileSize = (long) pgnStatus.st_size;
+
+   if (loadPGNData(pgnfile, filename) != 0)
    {
       return -1;
    }
+
+   indexfileName = getIndexfileName(filename);
+
+   if (indexfileName == 0 ||
+       loadIndex(pgnfile, indexfileName, &pgnStatus) == FALSE)
+   {
+      pgnfile->numGames = 0;
+      buildIndex(pgnfile);
+
+      if (indexfileName != 0)
+      {
+         saveIndex(pgnfile, indexfileName, &pgnStatus);
+      }
+   }
+
+   free(indexfileName);
+
+   return 0;
 }
 
 void closePGNFile(PGNFile * pgnfile)
@@ -170,15 +334,26 @@ void closePGNFile(PGNFile * pgnfile)
    if (pgnfile->index != 0)
    {
       free(pgnfile->index);
+      pgnfile->index = 0;
    }
 
    pgnfile->indexSize = 0;
    pgnfile->numGames = 0;
 
-   if (pgnfile->file != 0)
+   if (pgnfile->data != 0)
    {
-      fclose(pgnfile->file);
-      pgnfile->file = 0;
+#ifdef TARGET_LINUX
+      if (pgnfile->mapped)
+      {
+         munmap(pgnfile->data, (size_t) pgnfile->fileSize);
+      }
+      else
+#endif
+      {
+         free(pgnfile->data);
+      }
+
+      pgnfile->data = 0;
    }
 }
 
@@ -193,25 +368,17 @@ static char *getGameText(PGNFile * pgnfile, int number)
    }
 
    start = pgnfile->index[number - 1];
-   end = pgnfile->index[number] - 1;
-   length = (int) (end - start);
+   end = min(pgnfile->index[number] - 1, pgnfile->fileSize);
+   length = end - start;
 
-   if ((buffer = malloc(length + 1)) == NULL)
+   if (length < 0 || (buffer = malloc(length + 1)) == NULL)
    {
       return 0;
    }
 
-   fseek(pgnfile->file, start, SEEK_SET);
-
-   if (fread(buffer, 1, length, pgnfile->file) == length)
-   {
-      buffer[length] = '\0';
-      trim(buffer);
-   }
-   else
-   {
-      return 0;
-   }
+   memcpy(buffer, pgnfile->data + start, length);
+   buffer[length] = '\0';
+   trim(buffer);
 
    return buffer;
 }
@@ -1362,7 +1529,7 @@ static int testLoading()
 
    pgnfile.numGames = 0;
    pgnfile.index = 0;
-   pgnfile.file = 0;
+   pgnfile.data = 0;
 
    assert(openPGNFile(&pgnfile, "test.pgn") == 0);
    game = getGame(&pgnfile, 1);
@@ -28,10 +28,14 @@ typedef struct
    long *index;
    long indexSize;
    long numGames;
-   FILE *file;
+   char *data;                  /* the complete file, mapped or read */
+   long fileSize;
+   bool mapped;
 }
 PGNFile;
 
+#define PGN_INDEX_EXTENSION ".pgi"
+
 #define PGN_ROASTERLINE_SIZE 256
 
 typedef struct
@@ -75,7 +79,9 @@ typedef struct
 PGNGame;
 
 /**
- * Open the PGN file specified by 'filename'.
+ * Open the PGN file specified by 'filename'. The file is mapped into
+ * memory. The game offsets are read from 'filename.pgi' if that index
+ * is still up to date, otherwise they are scanned and saved there.
  *
  * @return 0 if the file could be opened without any error
  */
@@ -87,7 +93,8 @@ int openPGNFile(PGNFile * pgnfile, const char *filename);
 void closePGNFile(PGNFile * pgnfile);
 
 /**
- * Get the PGNGame specified by 'number'.
+ * Get the PGNGame specified by 'number'. Several threads may load
+ * games from the same file concurrently.
  *
  * @param number the number of the game to be loaded [1...pgnfile.numGames]
  * @param pgngame the struct supposed to contain the game data. It is 
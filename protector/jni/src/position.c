@@ -1009,6 +1009,7 @@ void shrinkHistoryValues(Variation * variation)
 void initializeVariation(Variation * variation, const char *fen)
 {
    variation->ply = 0;
+   variation->hashtable = 0;
    readFen(fen, &variation->singlePosition);
    prepareSearch(variation);
    variation->startPosition = variation->singlePosition;
@@ -1017,6 +1018,7 @@ void initializeVariation(Variation * variation, const char *fen)
 void setBasePosition(Variation * variation, const Position * position)
 {
    variation->ply = 0;
+   variation->hashtable = 0;
    variation->singlePosition = *position;
    variation->startPosition = variation->singlePosition;
 }
@@ -1268,14 +1270,18 @@ int makeMove(Variation * variation, const Move move)
 
 int makeMoveFast(Variation * variation, const Move move)
 {
-   if (variation->singlePosition.activeColor == WHITE)
-   {
-      return makeWhiteMove(variation, move);
-   }
-   else
+   const int result = (variation->singlePosition.activeColor == WHITE ?
+                       makeWhiteMove(variation, move) :
+                       makeBlackMove(variation, move));
+
+   /* The new position will be probed next; start loading its cluster now */
+   if (variation->hashtable != 0)
    {
-      return makeBlackMove(variation, move);
+      prefetchHashentry(variation->hashtable,
+                        variation->singlePosition.hashKey);
    }
+
+   return result;
 }
 
 void unmakeLastMove(Variation * variation)
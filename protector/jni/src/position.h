@@ -178,17 +178,36 @@ typedef struct
 }
 Hashentry;
 
+#define NODE_BUCKET_SIZE 8
+
 typedef struct
 {
-   UINT64 key;
-   UINT8 depth;
+   UINT64 slot[NODE_BUCKET_SIZE];       /* key[63..16] depth[15..8] count[7..0] */
 }
 Nodeentry;
 
+typedef struct
+{
+   UINT64 deferrals, claims, bucketsFull;
+   UINT8 padding[64 - 3 * 8];
+}
+NodeUsageStatistics;
+
+#define HASHTABLE_CACHE_LINE_SIZE 64
+
+typedef struct
+{
+   UINT64 entriesUsed;
+   UINT8 padding[HASHTABLE_CACHE_LINE_SIZE - sizeof(UINT64)];
+}
+HashtableUsage;
+
 typedef struct
 {
    Hashentry *table;
-   UINT64 tableSize, entriesUsed;
+   void *memory;
+   UINT64 tableSize, hashMask;
+   HashtableUsage usage[MAX_THREADS];
    UINT8 date;
 }
 Hashtable;
@@ -205,10 +224,8 @@ SearchStatus;
 #define HISTORY_SIZE (16*64)
 #define HISTORY_MAX  16384
 #define HISTORY_LIMIT 60        /* (60%) */
-#define PAWN_HASHTABLE_MASK 0xffff
-#define PAWN_HASHTABLE_SIZE ((PAWN_HASHTABLE_MASK)+0x0001)
-#define KINGSAFETY_HASHTABLE_MASK 0x07ffff
-#define KINGSAFETY_HASHTABLE_SIZE ((KINGSAFETY_HASHTABLE_MASK)+0x0001)
+#define PAWN_HASHTABLE_DEFAULT_SIZE_MB 4
+#define KINGSAFETY_HASHTABLE_DEFAULT_SIZE_MB 8
 
 typedef struct
 {
@@ -228,8 +245,36 @@ typedef struct
 }
 KingSafetyHashInfo;
 
-extern KingSafetyHashInfo
-   kingSafetyHashtable[MAX_THREADS][KINGSAFETY_HASHTABLE_SIZE];
+/**
+ * The pawn and king safety tables are owned by a single thread each, so
+ * their lookup and hit counters are updated without synchronization.
+ * The structures are cache line aligned to keep the counters of
+ * different threads apart.
+ */
+typedef struct
+{
+   PawnHashInfo *table;
+   void *memory;
+   UINT64 tableSize, hashMask;
+   UINT64 lookups, hits;
+}
+__attribute__ ((aligned(HASHTABLE_CACHE_LINE_SIZE))) PawnHashtable;
+
+typedef struct
+{
+   KingSafetyHashInfo *table;
+   void *memory;
+   UINT64 tableSize, hashMask;
+   UINT64 lookups, hits;
+}
+__attribute__ ((aligned(HASHTABLE_CACHE_LINE_SIZE))) KingSafetyHashtable;
+
+typedef struct
+{
+   UINT64 pawnLookups, pawnHits;
+   UINT64 kingsafetyLookups, kingsafetyHits;
+}
+EvalHashStatistics;
 
 #define BONUS_HIDDEN_PASSER
 
@@ -296,7 +341,7 @@ typedef struct
    int kingSquaresAttackCount[2];
    int spaceAttackPoints[2];
    bool evaluateKingSafety[2];
-   KingSafetyHashInfo *kingsafetyHashtable;
+   KingSafetyHashtable *kingsafetyHashtable;
    INT32 balance, materialBalance;
    MaterialInfo *materialInfo;
    Color ownColor;
@@ -313,8 +358,9 @@ typedef struct
    PrincipalVariation completePv;
    PrincipalVariation pv[MAX_NUM_PV];
    int pvId;
-   PawnHashInfo *pawnHashtable;
-   KingSafetyHashInfo *kingsafetyHashtable;
+   PawnHashtable *pawnHashtable;
+   KingSafetyHashtable *kingsafetyHashtable;
+   Hashtable *hashtable;
    UINT64 positionHistory[POSITION_HISTORY_OFFSET + MAX_DEPTH_ARRAY_SIZE];
    UINT64 nodes, nodesAtTimeCheck, nodesBetweenTimecheck;
    UINT16 historyValue[HISTORY_SIZE];
@@ -322,6 +368,7 @@ typedef struct
    Move counterMove1[HISTORY_SIZE], counterMove2[HISTORY_SIZE];
    Move followupMove1[HISTORY_SIZE], followupMove2[HISTORY_SIZE];
    unsigned long startTime, timeTarget, timeLimit, finishTime, timestamp;
+   unsigned long solutionTime;  /* when the accepted solution was found */
    unsigned long startTimeProcess, finishTimeProcess, hashSendTimestamp;
    unsigned long tbHits;
    bool handleUciEvents;
@@ -270,6 +270,7 @@ static void parseOptions(int argc, char **argv, CommandlineOptions * options)
    options->xboardMode = TRUE;
    options->dumpEvaluation = FALSE;
    options->testfile = 0;
+   options->resultfile = 0;
    options->bookfile = 0;
    options->tablebasePath = 0;
 
@@ -294,6 +295,11 @@ static void parseOptions(int argc, char **argv, CommandlineOptions * options)
          options->xboardMode = FALSE;
       }
 
+      if (strcmp(currentArg, "-o") == 0 && i < argc - 1)
+      {
+         options->resultfile = argv[++i];
+      }
+
       if (strcmp(currentArg, "-e") == 0 && i < argc - 1)
       {
          options->tablebasePath = argv[++i];
@@ -302,6 +308,24 @@ static void parseOptions(int argc, char **argv, CommandlineOptions * options)
       if (strcmp(currentArg, "-b") == 0 && i < argc - 1)
       {
          options->bookfile = argv[++i];
+         options->xboardMode = FALSE;
+      }
+
+      if (strcmp(currentArg, "-j") == 0 && i < argc - 1)
+      {
+         setNumberOfThreads(atoi(argv[++i]));
+      }
+
+      if (strcmp(currentArg, "-p") == 0 && i < argc - 1)
+      {
+         setPawnHashtableSizeInMb((unsigned int)
+                                  max(1, min(1024, atoi(argv[++i]))));
+      }
+
+      if (strcmp(currentArg, "-k") == 0 && i < argc - 1)
+      {
+         setKingsafetyHashtableSizeInMb((unsigned int)
+                                        max(1, min(1024, atoi(argv[++i]))));
       }
 
       if (strcmp(currentArg, "-v") == 0)
@@ -338,7 +362,8 @@ int main(int argc, char **argv)
 
    if (commandlineOptions.testfile != 0)
    {
-      if (processTestsuite(commandlineOptions.testfile) != 0)
+      if (processTestsuite(commandlineOptions.testfile,
+                           commandlineOptions.resultfile) != 0)
       {
          return -1;
       }
@@ -346,9 +371,10 @@ int main(int argc, char **argv)
 
    if (commandlineOptions.bookfile != 0)
    {
-      createEmptyBook(&globalBook);
-      appendBookDatabase(&globalBook, commandlineOptions.bookfile, 50);
-      closeBook(&globalBook);
+      if (buildBook("book", commandlineOptions.bookfile, 50) != 0)
+      {
+         return -1;
+      }
    }
 
    logDebug("Main thread terminated.\n");
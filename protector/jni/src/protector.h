@@ -242,7 +242,7 @@ typedef struct
    bool processModuleTest;
    bool xboardMode;
    bool dumpEvaluation;
-   char *testfile, *bookfile;
+   char *testfile, *resultfile, *bookfile;
    char *tablebasePath;
 }
 CommandlineOptions;
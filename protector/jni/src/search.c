@@ -216,8 +216,8 @@ static bool positionIsWellKnown(Variation * variation,
                                 Move * hashmove,
                                 const Move excludeMove, int *value)
 {
-   Hashentry *tableHit = getHashentry(getSharedHashtable(),
-                                      hashKey);
+   Hashentry *tableHit = getHashentry(variation->hashtable,
+                                      hashKey, variation->threadNumber);
 
    if (tableHit != NULL)
    {                            /* 45% */
@@ -459,10 +459,11 @@ static int searchBestQuiescence(Variation * variation, int alpha, int beta,
             {
                UINT8 hashentryFlag = HASHVALUE_EVAL;
 
-               setHashentry(getSharedHashtable(), position->hashKey,
+               setHashentry(variation->hashtable, position->hashKey,
                             calcHashtableValue(best, ply),
                             0, packedMove(NO_MOVE), hashentryFlag,
-                            (INT16) getStaticValue(variation, ply));
+                            (INT16) getStaticValue(variation, ply),
+                            variation->threadNumber);
             }
 
             return best;
@@ -626,10 +627,11 @@ static int searchBestQuiescence(Variation * variation, int alpha, int beta,
                        HASHVALUE_EXACT : HASHVALUE_UPPER_LIMIT);
    }
 
-   setHashentry(getSharedHashtable(), position->hashKey,
+   setHashentry(variation->hashtable, position->hashKey,
                 calcHashtableValue(best, ply),
                 hashDepth, packedMove(*bestMove), hashentryFlag,
-                (INT16) getStaticValue(variation, ply));
+                (INT16) getStaticValue(variation, ply),
+                variation->threadNumber);
 
    return best;
 }
@@ -1038,9 +1040,9 @@ static int searchBest(Variation * variation, int alpha, int beta,
       if (hashmove != NO_MOVE && excludeMove == NO_MOVE &&
           restDepth >= getSingleMoveExtensionDepth(pvNode))
       {
-         Hashentry *tableHit = getHashentry(getSharedHashtable(),
+         Hashentry *tableHit = getHashentry(variation->hashtable,
                                             variation->singlePosition.
-                                            hashKey);
+                                            hashKey, variation->threadNumber);
 
          if (tableHit != 0)
          {
@@ -1216,7 +1218,8 @@ static int searchBest(Variation * variation, int alpha, int beta,
           stage == MGS_REST && deferCount < 10 &&
           checkNodeExclusion(restDepth))
       {
-         if (nodeIsInUse(position->hashKey, restDepth))
+         if (nodeIsInUse(position->hashKey, restDepth,
+                         variation->threadNumber))
          {
             deferMove(&movelist, currentMove);
             deferCount++;
@@ -1225,7 +1228,8 @@ static int searchBest(Variation * variation, int alpha, int beta,
          }
          else
          {
-            nodeWasBlocked = setNodeUsage(position->hashKey, restDepth);
+            nodeWasBlocked = setNodeUsage(position->hashKey, restDepth,
+                                          variation->threadNumber);
          }
       }
 
@@ -1467,11 +1471,12 @@ static int searchBest(Variation * variation, int alpha, int beta,
                           HASHVALUE_EXACT : HASHVALUE_UPPER_LIMIT);
       }
 
-      setHashentry(getSharedHashtable(), hashKey,
+      setHashentry(variation->hashtable, hashKey,
                    calcHashtableValue(best, ply),
                    (UINT8) (restDepth + HASH_DEPTH_OFFSET),
                    packedMove(*bestMove), hashentryFlag,
-                   (INT16) getStaticValue(variation, ply));
+                   (INT16) getStaticValue(variation, ply),
+                   variation->threadNumber);
 
 #ifdef SEND_HASH_ENTRIES
       if (hashentryFlag == HASHVALUE_EXACT &&
@@ -1512,8 +1517,9 @@ void copyPvFromHashtable(Variation * variation, const int pvIndex,
    }
    else
    {
-      Hashentry *tableHit = getHashentry(getSharedHashtable(),
-                                         variation->singlePosition.hashKey);
+      Hashentry *tableHit = getHashentry(variation->hashtable,
+                                         variation->singlePosition.hashKey,
+                                         variation->threadNumber);
 
       if (tableHit != NULL)
       {
@@ -1552,8 +1558,9 @@ static void copyPvToHashtable(Variation * variation,
       UINT8 importance = (UINT8) HASH_DEPTH_OFFSET;
       bool entryExists = FALSE;
       Move bestMove = NO_MOVE;
-      Hashentry *tableHit = getHashentry(getSharedHashtable(),
-                                         variation->singlePosition.hashKey);
+      Hashentry *tableHit = getHashentry(variation->hashtable,
+                                         variation->singlePosition.hashKey,
+                                         variation->threadNumber);
 
       if (tableHit != 0)
       {
@@ -1573,10 +1580,11 @@ static void copyPvToHashtable(Variation * variation,
          /* Store the move in the transposition table. */
          /* ------------------------------------------- */
 
-         setHashentry(getSharedHashtable(),
+         setHashentry(variation->hashtable,
                       variation->singlePosition.hashKey, VALUE_MATED,
                       importance, packedMove(move),
-                      hashentryFlag, getEvalValue(variation));
+                      hashentryFlag, getEvalValue(variation),
+                      variation->threadNumber);
       }
 
       makeMove(variation, move);
@@ -1803,11 +1811,11 @@ static void exploreBaseMoves(Variation * variation, Movelist * basemoves,
             hashentryFlag = HASHVALUE_UPPER_LIMIT;
          }
 
-         setHashentry(getSharedHashtable(), position->hashKey,
+         setHashentry(variation->hashtable, position->hashKey,
                       calcHashtableValue(best, ply),
                       (UINT8) (depth + HASH_DEPTH_OFFSET),
                       packedMove(bestMove), hashentryFlag,
-                      (INT16) staticValue);
+                      (INT16) staticValue, variation->threadNumber);
       }
 
       worstValue = (numPvs == 1 ? best :
@@ -1860,27 +1868,6 @@ static void exploreBaseMoves(Variation * variation, Movelist * basemoves,
    sendPvInfo(variation, SEARCHEVENT_PLY_FINISHED);
 }
 
-static void initializePawnHashtable(PawnHashInfo * pawnHashtable)
-{
-   int i;
-
-   for (i = 0; i < PAWN_HASHTABLE_SIZE; i++)
-   {
-      pawnHashtable[i].hashKey = 0;
-   }
-}
-
-static void initializeKingsafetyHashtable(KingSafetyHashInfo *
-                                          kingsafetyHashtable)
-{
-   int i;
-
-   for (i = 0; i < KINGSAFETY_HASHTABLE_SIZE; i++)
-   {
-      kingsafetyHashtable[i].hashKey = 0;
-   }
-}
-
 static void updatePieceValues()
 {
    maxPieceValue[WHITE_QUEEN] = maxPieceValue[BLACK_QUEEN] =
@@ -1912,9 +1899,9 @@ Move search(Variation * variation, Movelist * acceptableSolutions)
 
    if (resetSharedHashtable)
    {
-      resetHashtable(getSharedHashtable());
-      initializePawnHashtable(variation->pawnHashtable);
-      initializeKingsafetyHashtable(variation->kingsafetyHashtable);
+      resetHashtable(variation->hashtable);
+      resetPawnHashtable(variation->pawnHashtable);
+      resetKingsafetyHashtable(variation->kingsafetyHashtable);
       resetSharedHashtable = FALSE;
    }
 
@@ -2014,12 +2001,14 @@ Move search(Variation * variation, Movelist * acceptableSolutions)
          if (stableIterationCount == 1)
          {
             nodeCount = variation->nodes;
+            variation->solutionTime = getTimestamp();
          }
       }
       else
       {
          stableIterationCount = 0;
          nodeCount = variation->nodes;
+         variation->solutionTime = getTimestamp();
       }
 
       /* Check for a fail low. */
@@ -2117,7 +2106,7 @@ Move search(Variation * variation, Movelist * acceptableSolutions)
 
          if (variation->threadNumber == 0)
          {
-            incrementDate(getSharedHashtable());
+            incrementDate(variation->hashtable);
             handleSearchEvent(SEARCHEVENT_SEARCH_FINISHED, variation);
          }
       }
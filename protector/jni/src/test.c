@@ -17,24 +17,84 @@
     along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 */
+#if __STDC_VERSION__ >= 199901L
+#define _XOPEN_SOURCE 600
+#else
+#define _XOPEN_SOURCE 500
+#endif /* __STDC_VERSION__ */
 
 #include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
+#include <pthread.h>
 #include "test.h"
 #include "io.h"
 #include "pgn.h"
 #include "coordination.h"
 #include "evaluation.h"
+#include "search.h"
+#include "hash.h"
+#include "protector.h"
+
+#define SUITE_TIME_LIMIT (60 * 1000)
+#define MAX_SUITE_SOLUTIONS 16
+
+typedef struct
+{
+   long number;
+   char name[2 * PGN_ROASTERLINE_SIZE + 2];
+   char fen[PGN_ROASTERLINE_SIZE];
+   bool mateProblem;
+   int numberOfMoves;
+   Move solutions[MAX_SUITE_SOLUTIONS];
+   int numberOfSolutions;
+
+   Move move;                   /* the calculated move */
+   bool solved;
+   long time, solutionTime;     /* msec overall and msec to solution */
+   UINT64 nodes;                /* the number of nodes to solution */
+   int depth;
+}
+SuiteEntry;
+
+typedef struct
+{
+   SuiteEntry **entries;
+   long numberOfEntries, numberOfGames;
+   long nextEntry;
+   int finishedWorkers;
+   pthread_mutex_t reportMutex;
+}
+SuiteRun;
+
+typedef struct
+{
+   SuiteRun *run;
+   pthread_t thread;
+   Variation *variation;
+   Hashtable hashtable;
+   PawnHashtable pawnHashtable;
+   KingSafetyHashtable kingsafetyHashtable;
+   volatile unsigned long deadline;
+}
+SuiteWorker;
 
 extern bool resetSharedHashtable;
 
+static bool quietSearchEvents = FALSE;
+
 void handleCliSearchEvent(int eventId, Variation * variation)
 {
    long time;
    char *pvMoves;
 
+   if (quietSearchEvents)
+   {
+      return;
+   }
+
    switch (eventId)
    {
    case SEARCHEVENT_SEARCH_FINISHED:
@@ -89,13 +149,6 @@ static bool solveMateProblem(SearchTask * entry)
    return result;
 }
 
-static bool solveBestMoveProblem(SearchTask * entry)
-{
-   completeTask(entry);
-
-   return listContainsMove(&entry->solutions, entry->bestMove);
-}
-
 static bool dumpEvaluation(SearchTask * entry)
 {
    EvaluationBase base;
@@ -109,19 +162,384 @@ static bool dumpEvaluation(SearchTask * entry)
    return TRUE;
 }
 
-int processTestsuite(const char *filename)
+static void fillSuiteEntry(SuiteEntry * entry, long number, PGNGame * game)
+{
+   Gamemove *gamemove = game->firstMove;
+   const char *mateTag = strstr(game->white, "[#");
+
+   entry->number = number;
+   snprintf(entry->name, sizeof(entry->name), "%s-%s",
+            game->white, game->black);
+   strncpy(entry->fen, game->fen, sizeof(entry->fen) - 1);
+   entry->fen[sizeof(entry->fen) - 1] = '\0';
+   entry->mateProblem = (bool) (mateTag != NULL);
+   entry->numberOfMoves = (mateTag != NULL ? atoi(mateTag + 2) : 0);
+   entry->numberOfSolutions = 0;
+
+   while (gamemove != 0 && entry->numberOfSolutions < MAX_SUITE_SOLUTIONS)
+   {
+      entry->solutions[entry->numberOfSolutions++] =
+         getPackedMove(gamemove->from, gamemove->to, gamemove->newPiece);
+
+      gamemove = gamemove->alternativeMove;
+   }
+
+   entry->move = NO_MOVE;
+   entry->solved = FALSE;
+   entry->time = entry->solutionTime = 0;
+   entry->nodes = 0;
+   entry->depth = 0;
+}
+
+static void setTaskSolutions(SearchTask * task, const SuiteEntry * entry)
+{
+   int i;
+
+   task->solutions.numberOfMoves = entry->numberOfSolutions;
+
+   for (i = 0; i < entry->numberOfSolutions; i++)
+   {
+      task->solutions.moves[i] = entry->solutions[i];
+   }
+}
+
+static void *executeSuiteWorker(void *arg)
+{
+   SuiteWorker *worker = arg;
+   Variation *variation = worker->variation;
+   Movelist solutions;
+   long index;
+
+   while ((index = __sync_fetch_and_add(&worker->run->nextEntry, 1)) <
+          worker->run->numberOfEntries)
+   {
+      SuiteEntry *entry = worker->run->entries[index];
+      char moveText[16];
+      char ns[32];
+      int i;
+
+      initializeVariation(variation, entry->fen);
+      resetHashtable(&worker->hashtable);
+      resetPawnHashtable(&worker->pawnHashtable);
+      resetKingsafetyHashtable(&worker->kingsafetyHashtable);
+
+      variation->pawnHashtable = &worker->pawnHashtable;
+      variation->kingsafetyHashtable = &worker->kingsafetyHashtable;
+      variation->hashtable = &worker->hashtable;
+      variation->threadNumber = 0;
+      variation->handleUciEvents = FALSE;
+      variation->ponderMode = FALSE;
+      variation->timeTarget = variation->timeLimit = SUITE_TIME_LIMIT;
+      variation->searchStatus = SEARCH_STATUS_RUNNING;
+      variation->terminate = FALSE;
+      variation->startTime = getTimestamp();
+      variation->solutionTime = 0;
+      worker->deadline = variation->startTime + SUITE_TIME_LIMIT;
+
+      solutions.numberOfMoves = entry->numberOfSolutions;
+
+      for (i = 0; i < entry->numberOfSolutions; i++)
+      {
+         solutions.moves[i] = entry->solutions[i];
+      }
+
+      entry->move = search(variation, &solutions);
+      worker->deadline = 0;
+
+      entry->solved = listContainsMove(&solutions, entry->move);
+      entry->time = (long) (getTimestamp() - variation->startTime);
+
+      /* Without a completed iteration the whole search time counts. */
+      entry->solutionTime = (variation->solutionTime == 0 ? entry->time :
+                             (long) (variation->solutionTime -
+                                     variation->startTime));
+      entry->nodes = variation->nodes;
+      entry->depth = variation->iteration;
+
+      getMoveDump(entry->move, moveText);
+      formatLongInteger(entry->nodes, ns);
+
+      pthread_mutex_lock(&worker->run->reportMutex);
+      logReport("%ld (%ld): %s %s %s in %ld msec (%s nodes, depth %d)\n",
+                entry->number, worker->run->numberOfGames, entry->name,
+                moveText, (entry->solved ? "solved" : "not solved"),
+                entry->solutionTime, ns, entry->depth);
+      pthread_mutex_unlock(&worker->run->reportMutex);
+   }
+
+   __sync_add_and_fetch(&worker->run->finishedWorkers, 1);
+
+   return 0;
+}
+
+static void watchSuiteWorkers(SuiteRun * run, SuiteWorker * workers,
+                              int numberOfWorkers)
+{
+   struct timespec requested, remaining;
+   int i;
+
+   requested.tv_sec = 0;
+   requested.tv_nsec = 10 * 1000000;
+
+   while (__sync_add_and_fetch(&run->finishedWorkers, 0) < numberOfWorkers)
+   {
+      const unsigned long now = getTimestamp();
+
+      for (i = 0; i < numberOfWorkers; i++)
+      {
+         const unsigned long deadline = workers[i].deadline;
+
+         if (deadline != 0 && now >= deadline)
+         {
+            workers[i].variation->terminate = TRUE;
+         }
+      }
+
+      nanosleep(&requested, &remaining);
+   }
+}
+
+/**
+ * Solve all best move problems of the specified run. The positions are
+ * distributed across independent single-threaded searches, each one
+ * with its own transposition table.
+ */
+static int solveBestMoveProblems(SuiteRun * run)
+{
+   const int numberOfThreads = getNumberOfThreads();
+   const int numberOfWorkers =
+      (int) min((long) numberOfThreads, max(1, run->numberOfEntries));
+   const UINT64 sharedSize =
+      getSharedHashtable()->tableSize * sizeof(Hashentry);
+   const UINT64 workerSize =
+      max(sharedSize / numberOfWorkers, (UINT64) 1024 * 1024);
+   SuiteWorker *workers;
+   int i;
+
+   if (run->numberOfEntries == 0)
+   {
+      return 0;
+   }
+
+   workers = calloc(numberOfWorkers, sizeof(SuiteWorker));
+
+   if (workers == 0)
+   {
+      return -1;
+   }
+
+   /* The workers search independently; keep ABDADA out of their way. */
+   setNumberOfThreads(1);
+   quietSearchEvents = TRUE;
+
+   for (i = 0; i < numberOfWorkers; i++)
+   {
+      SuiteWorker *worker = &workers[i];
+
+      worker->run = run;
+      worker->variation = malloc(sizeof(Variation));
+      setPawnHashtableSize(&worker->pawnHashtable, getPawnHashtableSize());
+      setKingsafetyHashtableSize(&worker->kingsafetyHashtable,
+                                 getKingsafetyHashtableSize());
+      initializeHashtable(&worker->hashtable);
+      setHashtableSize(&worker->hashtable, workerSize);
+
+      if (worker->variation == 0 || worker->hashtable.memory == 0)
+      {
+         logDebug("### Suite worker #%d could not be allocated. ###\n", i);
+
+         exit(EXIT_FAILURE);
+      }
+
+      if (pthread_create(&worker->thread, NULL, &executeSuiteWorker,
+                         worker) != 0)
+      {
+         logDebug("### Suite worker #%d could not be started. ###\n", i);
+
+         exit(EXIT_FAILURE);
+      }
+   }
+
+   watchSuiteWorkers(run, workers, numberOfWorkers);
+
+   for (i = 0; i < numberOfWorkers; i++)
+   {
+      SuiteWorker *worker = &workers[i];
+
+      pthread_join(worker->thread, NULL);
+      free(worker->hashtable.memory);
+      deleteKingsafetyHashtable(&worker->kingsafetyHashtable);
+      deletePawnHashtable(&worker->pawnHashtable);
+      free(worker->variation);
+   }
+
+   free(workers);
+   quietSearchEvents = FALSE;
+   setNumberOfThreads(numberOfThreads);
+
+   return 0;
+}
+
+static void writeCsvString(FILE * file, const char *text)
+{
+   fputc('"', file);
+
+   for (; *text != '\0'; text++)
+   {
+      if (*text == '"')
+      {
+         fputc('"', file);
+      }
+
+      fputc(*text, file);
+   }
+
+   fputc('"', file);
+}
+
+static void writeJsonString(FILE * file, const char *text)
+{
+   fputc('"', file);
+
+   for (; *text != '\0'; text++)
+   {
+      const unsigned char c = (unsigned char) *text;
+
+      if (c == '"' || c == '\\')
+      {
+         fprintf(file, "\\%c", c);
+      }
+      else if (c < 0x20)
+      {
+         fprintf(file, "\\u%04x", c);
+      }
+      else
+      {
+         fputc(c, file);
+      }
+   }
+
+   fputc('"', file);
+}
+
+static void getSolutionsDump(const SuiteEntry * entry, char *buffer)
+{
+   int i;
+
+   buffer[0] = '\0';
+
+   for (i = 0; i < entry->numberOfSolutions; i++)
+   {
+      if (i > 0)
+      {
+         strcat(buffer, " ");
+      }
+
+      getMoveDump(entry->solutions[i], buffer + strlen(buffer));
+   }
+}
+
+/**
+ * Write the results of a test suite to 'filename'. The results are
+ * written as JSON if the file name ends with '.json', otherwise as CSV.
+ */
+static int writeSuiteResults(const char *filename, SuiteEntry * entries,
+                             long numberOfEntries)
+{
+   const char *extension = strrchr(filename, '.');
+   const bool json = (bool) (extension != NULL &&
+                             strcmp(extension, ".json") == 0);
+   FILE *file = fopen(filename, "w");
+   long i;
+
+   if (file == NULL)
+   {
+      logReport("Could not open result file '%s'\n", filename);
+
+      return -1;
+   }
+
+   if (json)
+   {
+      fprintf(file, "[\n");
+   }
+   else
+   {
+      fprintf(file, "number,name,type,solved,move,solutions,"
+              "time_ms,solution_time_ms,solution_nodes,depth\n");
+   }
+
+   for (i = 0; i < numberOfEntries; i++)
+   {
+      const SuiteEntry *entry = &entries[i];
+      const char *type = (entry->mateProblem ? "mate" : "best move");
+      char moveText[16];
+      char solutionsText[MAX_SUITE_SOLUTIONS * 16];
+
+      if (entry->move != NO_MOVE)
+      {
+         getMoveDump(entry->move, moveText);
+      }
+      else
+      {
+         moveText[0] = '\0';
+      }
+
+      getSolutionsDump(entry, solutionsText);
+
+      if (json)
+      {
+         fprintf(file, "  {\"number\": %ld, \"name\": ", entry->number);
+         writeJsonString(file, entry->name);
+         fprintf(file, ", \"type\": \"%s\", \"solved\": %s, \"move\": ",
+                 type, (entry->solved ? "true" : "false"));
+         writeJsonString(file, moveText);
+         fprintf(file, ", \"solutions\": ");
+         writeJsonString(file, solutionsText);
+         fprintf(file, ", \"time_ms\": %ld, \"solution_time_ms\": %ld, "
+                 "\"solution_nodes\": %llu, \"depth\": %d}%s\n",
+                 entry->time, entry->solutionTime,
+                 (unsigned long long) entry->nodes, entry->depth,
+                 (i < numberOfEntries - 1 ? "," : ""));
+      }
+      else
+      {
+         fprintf(file, "%ld,", entry->number);
+         writeCsvString(file, entry->name);
+         fprintf(file, ",%s,%d,%s,", type, (entry->solved ? 1 : 0),
+                 moveText);
+         writeCsvString(file, solutionsText);
+         fprintf(file, ",%ld,%ld,%llu,%d\n", entry->time,
+                 entry->solutionTime, (unsigned long long) entry->nodes,
+                 entry->depth);
+      }
+   }
+
+   if (json)
+   {
+      fprintf(file, "]\n");
+   }
+
+   fclose(file);
+
+   return 0;
+}
+
+int processTestsuite(const char *filename, const char *resultFilename)
 {
    PGNFile pgnfile;
    PGNGame *game;
-   SearchTask entry;
-   Gamemove *gamemove;
-   long i;
+   SearchTask task;
+   SuiteEntry *entries;
+   SuiteRun run;
+   long i, numberOfEntries = 0;
    UINT64 overallNodes = 0;
    const char *fmt = "\nTestsuite '%s': %d/%d solved, %s nodes\n";
    char ons[32];
-   int solved = 0;
+   int solved = 0, result = 0;
    String notSolved = getEmptyString();
    Variation variation;
+   unsigned long startTime;
 
    if (openPGNFile(&pgnfile, filename) != 0)
    {
@@ -131,11 +549,17 @@ int processTestsuite(const char *filename)
    logReport("\nProcessing file '%s' [%ld game(s)]\n", filename,
              pgnfile.numGames);
 
-   statCount1 = statCount2 = 0;
-   variation.timeTarget = 60 * 1000;
-   variation.timeLimit = 60 * 1000;
-   variation.ponderMode = FALSE;
-   entry.variation = &variation;
+   entries = malloc(max(1, pgnfile.numGames) * sizeof(SuiteEntry));
+   run.entries = malloc(max(1, pgnfile.numGames) * sizeof(SuiteEntry *));
+
+   if (entries == 0 || run.entries == 0)
+   {
+      free(run.entries);
+      free(entries);
+      closePGNFile(&pgnfile);
+
+      return -1;
+   }
 
    for (i = 1; i <= pgnfile.numGames; i++)
    {
@@ -146,78 +570,117 @@ int processTestsuite(const char *filename)
          continue;
       }
 
-      logReport("\n%ld (%ld): %s-%s\n", i, pgnfile.numGames,
-                game->white, game->black);
-      logPosition(&game->firstMove->position);
+      fillSuiteEntry(&entries[numberOfEntries++], i, game);
+      freePgnGame(game);
+   }
+
+   statCount1 = statCount2 = 0;
 
-      entry.solutions.numberOfMoves = 0;
-      gamemove = game->firstMove;
+   /* Best move problems are distributed across the available cores. */
+   run.numberOfEntries = 0;
+   run.nextEntry = 0;
+   run.finishedWorkers = 0;
+   run.numberOfGames = pgnfile.numGames;
+   pthread_mutex_init(&run.reportMutex, NULL);
 
-      while (gamemove != 0)
+   for (i = 0; i < numberOfEntries; i++)
+   {
+      if (entries[i].mateProblem == FALSE)
       {
-         entry.solutions.moves
-            [entry.solutions.numberOfMoves++] =
-            getPackedMove(gamemove->from, gamemove->to, gamemove->newPiece);
+         run.entries[run.numberOfEntries++] = &entries[i];
+      }
+   }
+
+   if (commandlineOptions.dumpEvaluation == FALSE)
+   {
+      result = solveBestMoveProblems(&run);
+   }
 
-         gamemove = gamemove->alternativeMove;
+   pthread_mutex_destroy(&run.reportMutex);
+
+   /* Mate problems and evaluation dumps are processed one by one. */
+   variation.timeTarget = SUITE_TIME_LIMIT;
+   variation.timeLimit = SUITE_TIME_LIMIT;
+   variation.ponderMode = FALSE;
+   task.variation = &variation;
+
+   for (i = 0; i < numberOfEntries && result == 0; i++)
+   {
+      SuiteEntry *entry = &entries[i];
+
+      if (entry->mateProblem == FALSE &&
+          commandlineOptions.dumpEvaluation == FALSE)
+      {
+         continue;
       }
 
-      initializeVariation(&variation, game->fen);
+      logReport("\n%ld (%ld): %s\n", entry->number, pgnfile.numGames,
+                entry->name);
+
+      initializeVariation(&variation, entry->fen);
+      logPosition(&variation.startPosition);
+      setTaskSolutions(&task, entry);
       resetSharedHashtable = TRUE;
       variation.handleUciEvents = FALSE;
 
-      if (strstr(game->white, "[#") != NULL)
+      if (entry->mateProblem)
       {
-         char *tmp = strstr(game->white, "[#");
+         task.type = TASKTYPE_TEST_MATE_IN_N;
+         task.numberOfMoves = entry->numberOfMoves;
+         startTime = getTimestamp();
 
-         entry.type = TASKTYPE_TEST_MATE_IN_N;
-         entry.numberOfMoves = atoi(tmp + 2);
+         entry->solved = solveMateProblem(&task);
 
-         if (solveMateProblem(&entry) != FALSE)
-         {
-            solved++;
-         }
-         else
+         if (entry->solved == FALSE)
          {
             assert(0);
          }
 
-         overallNodes += entry.nodes;
+         entry->move = (task.calculatedSolutions.numberOfMoves > 0 ?
+                        task.calculatedSolutions.moves[0] : NO_MOVE);
+         entry->time = entry->solutionTime =
+            (long) (getTimestamp() - startTime);
+         entry->nodes = task.nodes;
+         entry->depth = 2 * entry->numberOfMoves - 1;
       }
       else
       {
-         entry.type = TASKTYPE_TEST_BEST_MOVE;
-         entry.numberOfMoves = 0;
+         task.type = TASKTYPE_TEST_BEST_MOVE;
+         task.numberOfMoves = 0;
+         dumpEvaluation(&task);
+      }
+   }
 
-         if (commandlineOptions.dumpEvaluation)
-         {
-            dumpEvaluation(&entry);
-         }
-         else
-         {
-            if (solveBestMoveProblem(&entry) != FALSE)
-            {
-               solved++;
-            }
-            else
-            {
-               appendToString(&notSolved, "%d ", i);
-            }
-
-            overallNodes += entry.nodes;
-         }
+   for (i = 0; i < numberOfEntries; i++)
+   {
+      if (entries[i].solved)
+      {
+         solved++;
+      }
+      else if (entries[i].mateProblem == FALSE &&
+               commandlineOptions.dumpEvaluation == FALSE)
+      {
+         appendToString(&notSolved, "%ld ", entries[i].number);
       }
 
-      freePgnGame(game);
+      overallNodes += entries[i].nodes;
    }
 
    formatLongInteger(overallNodes, ons);
    logReport(fmt, filename, solved, pgnfile.numGames, ons);
    logReport("Not solved: %s\n", notSolved.buffer);
+
+   if (result == 0 && resultFilename != 0)
+   {
+      result = writeSuiteResults(resultFilename, entries, numberOfEntries);
+   }
+
    free(notSolved.buffer);
+   free(run.entries);
+   free(entries);
    closePGNFile(&pgnfile);
 
-   return 0;
+   return result;
 }
 
 /**
@@ -234,7 +697,7 @@ int testModuleTest()
 {
    int result;
 
-   if ((result = processTestsuite("moduletest.pgn")) != 0)
+   if ((result = processTestsuite("moduletest.pgn", 0)) != 0)
    {
       return result;
    }
@@ -24,11 +24,14 @@
 #include "position.h"
 
 /**
- * Process the testsuite specified by 'filename'.
+ * Process the testsuite specified by 'filename'. Best move problems are
+ * distributed across getNumberOfThreads() independent searches.
  *
+ * @param resultFilename if not 0, the per-position results are written
+ *        to this file (JSON if it ends with '.json', CSV otherwise)
  * @return 0 if no errors occurred.
  */
-int processTestsuite(const char *filename);
+int processTestsuite(const char *filename, const char *resultFilename);
 
 /**
  * Handle a search event defined by eventId.
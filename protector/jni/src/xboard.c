@@ -59,6 +59,8 @@ int maxPvHashEntriesSendPerSecond = MAX_ENTRIES_PS_DEFAULT;
 int pvHashEntriesSendInterval = 1000 / MAX_ENTRIES_PS_DEFAULT;
 
 const char *USN_NT = "Threads";
+const char *USN_PH = "Pawn Hash";
+const char *USN_KH = "King Safety Hash";
 const char *USN_QO = "Value Queen Opening";
 const char *USN_QE = "Value Queen Endgame";
 const char *USN_RO = "Value Rook Opening";
@@ -494,7 +496,7 @@ static void startPostPonderCalculation()
             variation.timeTarget, variation.timeLimit);
 #endif
 
-   startTimerThread(&task);
+   startTimer(&task);
 }
 
 /******************************************************************************
@@ -624,7 +626,7 @@ static void reportStatisticsUpdate(Variation * var)
    const double time = getTimestamp() - var->startTime;
    const double nps = (nodeCount / max((double) 0.001, (time / 1000.0)));
    const double hashUsage =
-      ((double) getSharedHashtable()->entriesUsed * 1000.0) /
+      ((double) getHashtableEntriesUsed(getSharedHashtable()) * 1000.0) /
       (max((double) 1.0, (double) getSharedHashtable()->tableSize));
 
    sendToXboardNonDebug
@@ -638,6 +640,44 @@ static void reportStatisticsUpdate(Variation * var)
    }
 }
 
+/******************************************************************************
+ *
+ * Report how often the threads deferred moves searched by other threads.
+ *
+ ******************************************************************************/
+static void reportNodeUsageStatistics(void)
+{
+   NodeUsageStatistics statistics;
+
+   if (getNumberOfThreads() > 1)
+   {
+      getNodeUsageStatistics(&statistics);
+      sendToXboardNonDebug
+         ("info string node usage: %llu deferrals %llu claims %llu buckets full",
+          statistics.deferrals, statistics.claims, statistics.bucketsFull);
+   }
+}
+
+/******************************************************************************
+ *
+ * Report the hit rates of the pawn and king safety hashtables.
+ *
+ ******************************************************************************/
+static void reportEvalHashStatistics(void)
+{
+   EvalHashStatistics statistics;
+
+   getEvalHashStatistics(&statistics);
+   sendToXboardNonDebug
+      ("info string pawn hash: %llu lookups %.1f%% hits king safety hash: %llu lookups %.1f%% hits",
+       statistics.pawnLookups,
+       (100.0 * statistics.pawnHits) /
+       max((double) 1.0, (double) statistics.pawnLookups),
+       statistics.kingsafetyLookups,
+       (100.0 * statistics.kingsafetyHits) /
+       max((double) 1.0, (double) statistics.kingsafetyLookups));
+}
+
 /******************************************************************************
  *
  * Send a bestmove info to the gui.
@@ -722,6 +762,9 @@ void handleUciSearchEvent(int eventId, Variation * variation)
    switch (eventId)
    {
    case SEARCHEVENT_SEARCH_FINISHED:
+      reportNodeUsageStatistics();
+      reportEvalHashStatistics();
+
       if (status.engineIsPondering == FALSE)
       {
          sendBestmoveInfo(variation);
@@ -799,7 +842,7 @@ void addHashentry(Hashentry * entry)
 {
    setHashentry(getSharedHashtable(), entry->key, getHashentryValue(entry),
                 getHashentryImportance(entry), getHashentryMove(entry),
-                getHashentryFlag(entry), getHashentryStaticValue(entry));
+                getHashentryFlag(entry), getHashentryStaticValue(entry), 0);
 }
 
 /******************************************************************************
@@ -836,6 +879,9 @@ static int processUciCommand(const char *command)
 #endif
       sendToXboardNonDebug("option name Ponder type check default true");
       sendUciSpinOption(USN_NT, 1, 1, MAX_THREADS);
+      sendUciSpinOption(USN_PH, PAWN_HASHTABLE_DEFAULT_SIZE_MB, 1, 1024);
+      sendUciSpinOption(USN_KH, KINGSAFETY_HASHTABLE_DEFAULT_SIZE_MB, 1,
+                        1024);
       sendUciSpinOption(USN_PO, DEFAULTVALUE_PAWN_OPENING,
                         getValueLimit(DEFAULTVALUE_PAWN_OPENING,
                                       -valueRangePct),
@@ -961,6 +1007,26 @@ static int processUciCommand(const char *command)
          return TRUE;
       }
 
+      if (strcmp(name, USN_PH) == 0)
+      {
+         setPawnHashtableSizeInMb((unsigned int)
+                                  getIntValue(value, 1,
+                                              PAWN_HASHTABLE_DEFAULT_SIZE_MB,
+                                              1024));
+
+         return TRUE;
+      }
+
+      if (strcmp(name, USN_KH) == 0)
+      {
+         setKingsafetyHashtableSizeInMb((unsigned int)
+                                        getIntValue(value, 1,
+                                                    KINGSAFETY_HASHTABLE_DEFAULT_SIZE_MB,
+                                                    1024));
+
+         return TRUE;
+      }
+
       if (strcmp(name, USN_NT) == 0)
       {
          const unsigned int numThreads =
@@ -1281,6 +1347,12 @@ static int processUciCommand(const char *command)
 
    if (strcmp(buffer, "go") == 0)
    {
+      /* A new search supersedes a search that is still running. */
+      getGuiSearchMutex();
+      prepareSearchAbort();
+      releaseGuiSearchMutex();
+      waitForSearchTermination();
+
       getGuiSearchMutex();
       status.engineIsActive = TRUE;
       task.type = TASKTYPE_BEST_MOVE;
@@ -1584,7 +1656,7 @@ static int testHashUpdate()
 
    sprintf(commandBuffer, transEntryStringFormat, entry.key, entry.data);
    processUciCommand(commandBuffer);
-   tableHit = getHashentry(hashtable, hashKey);
+   tableHit = getHashentry(hashtable, hashKey, 0);
 
    assert(tableHit != 0);
    assert(getHashentryValue(tableHit) == value);
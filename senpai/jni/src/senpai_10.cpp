@@ -27,13 +27,16 @@
 #include <cassert> // needs NDEBUG
 #include <cctype>
 #include <cmath>
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <ctime>
 
 // C++ includes
 
 #include <fstream>
 #include <iostream>
+#include <new>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -45,6 +48,17 @@
 #include <mutex>
 #include <thread>
 
+// OS includes
+
+#ifndef _WIN32
+#  include <sys/mman.h>
+#endif
+
+#if defined(__linux__) && !defined(__ANDROID__)
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#endif
+
 // macros
 
 #ifdef _MSC_VER
@@ -125,6 +139,10 @@ public:
 
 };
 
+int64 micro_time() { // for instrumentation only
+   return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
 class Lockable {
 
 protected: // HACK for Waitable::wait()
@@ -231,6 +249,143 @@ void log(const std::string & s) {
    log_file << s << std::endl;
 }
 
+const int CACHE_LINE = 64;
+
+void * alloc_aligned(std::size_t size) { // cache-line aligned, release with free_aligned()
+
+   char * raw = new char[size + CACHE_LINE + sizeof(void *)];
+
+   uintptr_t addr = uintptr_t(raw + sizeof(void *));
+   addr = (addr + CACHE_LINE - 1) & ~uintptr_t(CACHE_LINE - 1);
+
+   void * p = reinterpret_cast<void *>(addr);
+   reinterpret_cast<char **>(p)[-1] = raw;
+
+   return p;
+}
+
+void free_aligned(void * p) {
+   if (p != NULL) delete [] reinterpret_cast<char **>(p)[-1];
+}
+
+const std::size_t HUGE_PAGE = 2 << 20;
+
+std::size_t page_round(std::size_t size) {
+   return (size + HUGE_PAGE - 1) & ~(HUGE_PAGE - 1);
+}
+
+#if defined(__linux__) && !defined(__ANDROID__) && defined(SYS_mbind)
+
+uint64 numa_nodes() { // mask of online nodes (first 64)
+
+   std::ifstream file("/sys/devices/system/node/online");
+   std::string list;
+   if (!(file >> list)) return 0;
+
+   uint64 mask = 0;
+   std::stringstream ss(list);
+   std::string range;
+
+   while (std::getline(ss, range, ',')) {
+
+      int lo = 0;
+      int hi = 0;
+
+      std::size_t dash = range.find('-');
+      lo = int(to_int(range.substr(0, dash)));
+      hi = (dash == std::string::npos) ? lo : int(to_int(range.substr(dash + 1)));
+
+      for (int node = lo; node <= hi && node < 64; node++) {
+         mask |= U64(1) << node;
+      }
+   }
+
+   return mask;
+}
+
+void numa_interleave(void * p, std::size_t size) { // spread pages over all nodes; before first touch
+
+   uint64 mask = numa_nodes();
+   if ((mask & (mask - 1)) == 0) return; // single node
+
+   unsigned long nodes[64 / (8 * sizeof(unsigned long))];
+   std::memcpy(nodes, &mask, sizeof(nodes));
+
+   const int MPOL_INTERLEAVE_ = 3; // from <numaif.h>, not needed otherwise
+   syscall(SYS_mbind, p, size, MPOL_INTERLEAVE_, nodes, 64 + 1, 0); // ignore errors
+}
+
+#else
+
+void numa_interleave(void * /* p */, std::size_t /* size */) {
+}
+
+#endif
+
+#ifdef MADV_HUGEPAGE
+
+bool thp_enabled() { // madvise() also succeeds when transparent huge pages are "never"
+
+   std::ifstream file("/sys/kernel/mm/transparent_hugepage/enabled");
+   std::string mode;
+   if (!std::getline(file, mode)) return false;
+
+   return mode.find("[never]") == std::string::npos;
+}
+
+#endif
+
+void * alloc_pages(std::size_t size, bool & huge) { // large block, committed on first touch; NULL on failure
+
+   huge = false;
+
+#ifdef _WIN32
+
+   try {
+      return alloc_aligned(size);
+   } catch (const std::bad_alloc & /* error */) {
+      return NULL;
+   }
+
+#else
+
+   size = page_round(size);
+   void * p = MAP_FAILED;
+
+#  ifdef MAP_HUGETLB
+   p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON | MAP_HUGETLB, -1, 0); // reserved huge pages
+   huge = p != MAP_FAILED;
+#  endif
+
+   if (p == MAP_FAILED) {
+
+      p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
+      if (p == MAP_FAILED) return NULL;
+
+#  ifdef MADV_HUGEPAGE
+      huge = madvise(p, size, MADV_HUGEPAGE) == 0 && thp_enabled(); // transparent huge pages
+#  endif
+   }
+
+   numa_interleave(p, size);
+
+   return p;
+
+#endif
+}
+
+void free_pages(void * p, std::size_t size) {
+
+   if (p == NULL) return;
+
+#ifdef _WIN32
+   (void) size;
+   free_aligned(p);
+#else
+   munmap(p, page_round(size));
+#endif
+}
+
 }
 
 namespace input {
@@ -2296,8 +2451,8 @@ public:
       assert(score(pos) == sc);
    }
 
-   void move_to_front(int pos) {
-      move_to(pos, 0);
+   void move_to_front(int pos, int front = 0) { // front > 0 for MultiPV
+      move_to(pos, front);
    }
 
    void sort() { // insertion sort
@@ -3002,6 +3157,8 @@ void clear_entry(Entry & entry) {
    entry.pad_2 = 0;
 }
 
+const int MAX_HASH = (sizeof(void *) == 8) ? 1 << 20 : 2048; // MB
+
 class Table {
 
 private:
@@ -3010,6 +3167,8 @@ private:
    int p_bits;
    uint64 p_size;
    uint64 p_mask;
+   bool p_huge;
+   bool p_dirty; // cleared by the next search
 
    int p_date;
    uint64 p_used;
@@ -3033,6 +3192,8 @@ public:
       p_bits = 0;
       p_size = 1;
       p_mask = 0;
+      p_huge = false;
+      p_dirty = false;
 
       p_date = 0;
       p_used = 0;
@@ -3043,39 +3204,99 @@ public:
       int bits = size_to_bits(size);
       if (bits == p_bits) return;
 
-      p_bits = bits;
-      p_size = U64(1) << bits;
-      p_mask = p_size - 1;
-
       if (p_table != NULL) {
          free();
+         set_bits(bits);
          alloc();
+      } else {
+         set_bits(bits);
       }
    }
 
-   void alloc() {
+   void set_bits(int bits) {
+      p_bits = bits;
+      p_size = U64(1) << bits;
+      p_mask = p_size - 1;
+   }
+
+   void alloc() { // fast: the OS hands out pages on first touch, the next search clears them
+
       assert(p_table == NULL);
-      p_table = new Entry[p_size];
-      clear();
+
+      while (true) {
+
+         p_table = static_cast<Entry *>(util::alloc_pages(p_size * sizeof(Entry), p_huge));
+         if (p_table != NULL || p_bits <= 16) break;
+
+         set_bits(p_bits - 1); // not enough memory
+      }
+
+      if (p_table == NULL) {
+         std::cerr << "cannot allocate the transposition table" << std::endl;
+         std::exit(EXIT_FAILURE);
+      }
+
+      p_date = 1;
+      p_used = 0;
+      p_dirty = true;
    }
 
    void free() {
       assert(p_table != NULL);
-      delete [] p_table;
+      util::free_pages(p_table, p_size * sizeof(Entry));
       p_table = NULL;
    }
 
-   void clear() {
+   void clear_later() {
+      p_dirty = true;
+   }
+
+   bool dirty() const {
+      return p_dirty;
+   }
+
+   bool huge() const {
+      return p_huge;
+   }
+
+   int size() const { // MB
+      return int((p_size * sizeof(Entry)) >> 20);
+   }
+
+   void clear_range(uint64 begin, uint64 end) {
 
       Entry e;
       clear_entry(e);
 
-      for (uint64 i = 0; i < p_size; i++) {
+      for (uint64 i = begin; i < end; i++) {
          p_table[i] = e;
       }
+   }
+
+   void clear(int threads = 1) { // split among search threads for large tables
+
+      assert(p_table != NULL);
+
+      if (p_size < (U64(1) << 20)) threads = 1; // < 16 MB
+
+      uint64 chunk = (p_size + threads - 1) / threads;
+      std::vector<std::thread> worker;
+
+      for (int id = 1; id < threads; id++) { // skip 0
+         uint64 begin = std::min(p_size, chunk * id);
+         uint64 end = std::min(p_size, begin + chunk);
+         worker.push_back(std::thread(&Table::clear_range, this, begin, end));
+      }
+
+      clear_range(0, std::min(p_size, chunk));
+
+      for (int i = 0; i < int(worker.size()); i++) {
+         worker[i].join();
+      }
 
       p_date = 1;
       p_used = 0;
+      p_dirty = false;
    }
 
    void inc_date() {
@@ -3196,6 +3417,12 @@ struct Engine {
    int hash;
    bool ponder;
    int threads;
+   bool lazy_smp;
+   int pawn_hash;
+   int eval_hash;
+   bool shared_cache;
+   int multi_pv;
+   bool stats;
    bool log;
 };
 
@@ -3205,6 +3432,12 @@ void init() {
    engine.hash = 64;
    engine.ponder = false;
    engine.threads = 1;
+   engine.lazy_smp = false;
+   engine.pawn_hash = 1;
+   engine.eval_hash = 1;
+   engine.shared_cache = false;
+   engine.multi_pv = 1;
+   engine.stats = false;
    engine.log = false;
 }
 
@@ -4230,45 +4463,148 @@ class Table {
 
 private:
 
-   static const int BITS = 12;
-   static const int SIZE = 1 << BITS;
-   static const int MASK = SIZE - 1;
+   Info * p_table;
+   int p_bits;
+   uint64 p_size;
+   uint64 p_mask;
+   bool p_shared; // entries belong to another table
+
+   int64 p_probe;
+   int64 p_hit;
+
+   static int size_to_bits(int size) {
+
+      int bits = 0;
+
+      for (uint64 entries = (uint64(size) << 20) / sizeof(Info); entries > 1; entries /= 2) {
+         bits++;
+      }
+
+      return bits;
+   }
+
+   static uint32 digest(const Info & info) { // NOTE: lock must be 0
+
+      uint64 word[sizeof(Info) / sizeof(uint64)];
+      std::memcpy(word, &info, sizeof(Info)); // no aliasing
+
+      uint64 x = 0;
 
-   Info p_table[SIZE];
+      for (int i = 0; i < int(sizeof(Info) / sizeof(uint64)); i++) {
+         x ^= word[i];
+      }
+
+      return uint32(x ^ (x >> 32));
+   }
+
+   void release() {
+
+      if (!p_shared) util::free_aligned(p_table);
+
+      p_table = NULL;
+      p_shared = false;
+   }
 
 public:
 
+   Table() {
+
+      p_table = NULL;
+      p_bits = 0;
+      p_size = 1;
+      p_mask = 0;
+      p_shared = false;
+
+      p_probe = 0;
+      p_hit = 0;
+   }
+
+   void set_size(int size) { // MB; allocates on first call
+
+      int bits = size_to_bits(size);
+      if (p_table != NULL && !p_shared && bits == p_bits) return;
+
+      release();
+
+      p_bits = bits;
+      p_size = U64(1) << bits;
+      p_mask = p_size - 1;
+
+      p_table = static_cast<Info *>(util::alloc_aligned(p_size * sizeof(Info)));
+      clear();
+   }
+
+   void share(const Table & table) { // use the entries of another table
+
+      assert(table.p_table != NULL);
+      if (p_table == table.p_table) return;
+
+      release();
+
+      p_table = table.p_table;
+      p_bits = table.p_bits;
+      p_size = table.p_size;
+      p_mask = table.p_mask;
+      p_shared = true;
+   }
+
+   void free() {
+      release();
+   }
+
    void clear() {
 
+      assert(p_table != NULL);
+
       Info info;
+      std::memset(&info, 0, sizeof(Info)); // padding takes part in digest()
       clear_info(info);
+      info.lock = 1; // board w/o pawns has key 0!
 
-      for (int index = 0; index < SIZE; index++) {
-         p_table[index] = info;
+      for (uint64 index = 0; index < p_size; index++) {
+         std::memcpy(&p_table[index], &info, sizeof(Info));
       }
    }
 
-   void clear_fast() {
-      for (int index = 0; index < SIZE; index++) {
-         p_table[index].lock = 1; // board w/o pawns has key 0!
-      }
+   void clear_stats() {
+      p_probe = 0;
+      p_hit = 0;
    }
 
-   const Info & info(const board::Board & bd) {
+   int64 probes () const { return p_probe; }
+   int64 hits   () const { return p_hit; }
+
+   Info info(const board::Board & bd) { // entries may be shared: validate a private copy with lock ^ digest
+
+      assert(p_table != NULL);
 
       hash_t key = bd.pawn_key();
 
-      int    index = hash::index(key) & MASK;
+      uint64 index = hash::index(key) & p_mask;
       uint32 lock  = hash::lock(key);
 
       Info & entry = p_table[index];
 
-      if (entry.lock != lock) {
-         entry.lock = lock;
-         comp_info(entry, bd);
+      Info info;
+      std::memcpy(&info, &entry, sizeof(Info));
+
+      uint32 check = info.lock;
+      info.lock = 0;
+
+      p_probe++;
+
+      if ((check ^ digest(info)) == lock) {
+         p_hit++;
+      } else {
+         std::memset(&info, 0, sizeof(Info));
+         comp_info(info, bd);
+         info.lock = 0;
+         info.lock = lock ^ digest(info);
+         std::memcpy(&entry, &info, sizeof(Info));
       }
 
-      return entry;
+      info.lock = lock;
+      return info;
    }
 
 };
@@ -4612,38 +4948,123 @@ class Table {
 
 private:
 
-   static const int BITS = 16;
-   static const int SIZE = 1 << BITS;
-   static const int MASK = SIZE - 1;
+   Entry * p_table;
+   int p_bits;
+   uint64 p_size;
+   uint64 p_mask;
+   bool p_shared; // entries belong to another table
+
+   int64 p_probe;
+   int64 p_hit;
+
+   static int size_to_bits(int size) {
+
+      int bits = 0;
+
+      for (uint64 entries = (uint64(size) << 20) / sizeof(Entry); entries > 1; entries /= 2) {
+         bits++;
+      }
+
+      return bits;
+   }
+
+   void release() {
+
+      if (!p_shared) util::free_aligned(p_table);
 
-   Entry p_table[SIZE];
+      p_table = NULL;
+      p_shared = false;
+   }
 
 public:
 
+   Table() {
+
+      p_table = NULL;
+      p_bits = 0;
+      p_size = 1;
+      p_mask = 0;
+      p_shared = false;
+
+      p_probe = 0;
+      p_hit = 0;
+   }
+
+   void set_size(int size) { // MB; allocates on first call
+
+      int bits = size_to_bits(size);
+      if (p_table != NULL && !p_shared && bits == p_bits) return;
+
+      release();
+
+      p_bits = bits;
+      p_size = U64(1) << bits;
+      p_mask = p_size - 1;
+
+      p_table = static_cast<Entry *>(util::alloc_aligned(p_size * sizeof(Entry)));
+      clear();
+   }
+
+   void share(const Table & table) { // use the entries of another table
+
+      assert(table.p_table != NULL);
+      if (p_table == table.p_table) return;
+
+      release();
+
+      p_table = table.p_table;
+      p_bits = table.p_bits;
+      p_size = table.p_size;
+      p_mask = table.p_mask;
+      p_shared = true;
+   }
+
+   void free() {
+      release();
+   }
+
    void clear() {
-      for (int index = 0; index < SIZE; index++) {
+
+      assert(p_table != NULL);
+
+      for (uint64 index = 0; index < p_size; index++) {
          p_table[index].lock = 0;
          p_table[index].eval = 0;
       }
    }
 
+   void clear_stats() {
+      p_probe = 0;
+      p_hit = 0;
+   }
+
+   int64 probes () const { return p_probe; }
+   int64 hits   () const { return p_hit; }
+
    int eval(const board::Board & bd, pawn::Table & pawn_table) { // NOTE: score for white
 
+      assert(p_table != NULL);
+
       hash_t key = bd.eval_key();
 
-      int    index = hash::index(key) & MASK;
+      uint64 index = hash::index(key) & p_mask;
       uint32 lock  = hash::lock(key);
 
       Entry & entry = p_table[index];
+      Entry e = entry; // entries may be shared: lock is stored xor eval
+
+      p_probe++;
 
-      if (entry.lock == lock) {
-         return entry.eval;
+      if ((e.lock ^ uint32(e.eval)) == lock) {
+         p_hit++;
+         return e.eval;
       }
 
       int eval = comp_eval(bd, pawn_table);
 
-      entry.lock = lock;
-      entry.eval = eval;
+      e.lock = lock ^ uint32(eval);
+      e.eval = eval;
+      entry = e;
 
       return eval;
    }
@@ -5111,7 +5532,7 @@ int comp_eval(const board::Board & bd, pawn::Table & pawn_table) { // NOTE: scor
    Attack_Info ai;
    comp_attacks(ai, bd);
 
-   const pawn::Info & pi = pawn_table.info(bd);
+   const pawn::Info pi = pawn_table.info(bd);
 
    int eval = 0;
    int mg = 0;
@@ -5417,7 +5838,8 @@ const int MAX_DEPTH = 100;
 const int MAX_PLY = 100;
 const int NODE_PERIOD = 1024;
 
-const int MAX_THREADS = 16;
+const int MAX_THREADS = 128;
+const int MAX_MULTI_PV = 256;
 
 class Abort : public std::exception { // SP fail-high exception
 
@@ -5507,6 +5929,7 @@ struct Time {
    int last_score;
    bool drop;
    util::Timer timer;
+   gen::List search_moves; // empty = all moves
 };
 
 struct Current {
@@ -5535,7 +5958,8 @@ struct Best {
 
 Time p_time;
 Current current;
-Best best;
+Best line[MAX_MULTI_PV]; // MultiPV lines, best first
+Best & best = line[0];
 
 class Search_Global : public util::Lockable {
 
@@ -5544,6 +5968,9 @@ public:
    trans::Table trans;
    sort::History history;
 
+   pawn::Table pawn_table; // only allocated for shared eval caches
+   eval::Table eval_table;
+
 };
 
 Search_Global sg;
@@ -5558,7 +5985,7 @@ class Search_Local;
 class Split_Point;
 
 void clear_iteration(Search_Local & sl);
-void search_root(Search_Local & sl, gen::List & ml, int depth, int alpha, int beta);
+void search_root(Search_Local & sl, gen::List & ml, int first, int depth, int alpha, int beta);
 int search(Search_Local & sl, int depth, int alpha, int beta, PV & pv);
 int split(Search_Local & sl, int depth, int old_alpha, int alpha, int beta, PV & pv, gen_sort::List & todo, const gen::List & done, int bs, int bm);
 void master_split_point(Search_Local & sl, Split_Point & sp);
@@ -5746,6 +6173,16 @@ public:
 
 Split_Point root_sp;
 
+struct Stats { // per thread, reported with the "Stats" option
+   int64 gen;         // move-list initialisations
+   int64 eval;        // eval() calls, see the eval tables for cache hits
+   int64 trans_probe;
+   int64 trans_hit;   // deep enough for a cutoff
+   int64 split;
+   int64 split_work;  // helpers sent to split points
+   int64 split_time;  // microseconds of split setup and master waiting, only measured with "Stats"
+};
+
 class Search_Local : public util::Waitable {
 
 public:
@@ -5761,6 +6198,8 @@ public:
    pawn::Table pawn_table;
    eval::Table eval_table;
 
+   Stats stats;
+
    int64 volatile node;
    int volatile max_ply;
 
@@ -5771,7 +6210,16 @@ public:
    int ssp_stack_size;
 };
 
-Search_Local p_sl[MAX_THREADS];
+Search_Local * p_sl[MAX_THREADS]; // allocated on first use
+
+void sl_alloc(int threads) {
+
+   assert(threads <= MAX_THREADS);
+
+   for (int id = 0; id < threads; id++) {
+      if (p_sl[id] == NULL) p_sl[id] = new Search_Local;
+   }
+}
 
 void new_search() {
 
@@ -5783,6 +6231,8 @@ void new_search() {
 
    p_time.smart = false;
    p_time.ponder = false;
+
+   p_time.search_moves.clear();
 }
 
 void set_depth_limit(int depth) {
@@ -5804,6 +6254,10 @@ void set_ponder() {
    p_time.ponder = true;
 }
 
+void add_search_move(int mv) {
+   if (!p_time.search_moves.contain(mv)) p_time.search_moves.add(mv);
+}
+
 void clear() {
 
    p_time.flag = false;
@@ -5837,7 +6291,7 @@ void update_current() {
 
    for (int id = 0; id < engine::engine.threads; id++) {
 
-      Search_Local & sl = p_sl[id];
+      Search_Local & sl = *p_sl[id];
 
       node += sl.node;
       if (sl.max_ply > max_ply) max_ply = sl.max_ply;
@@ -5850,11 +6304,12 @@ void update_current() {
    current.speed = (current.time < 10) ? 0 : int(current.node * 1000 / current.time);
 }
 
-void write_pv(Best & best) {
+void write_pv(Best & best, int index) {
 
    sg.lock();
 
    std::cout << "info";
+   if (engine::engine.multi_pv > 1) std::cout << " multipv " << index + 1;
    std::cout << " depth " << best.depth;
    std::cout << " seldepth " << current.max_ply;
    std::cout << " nodes " << current.node;
@@ -5874,6 +6329,33 @@ void write_pv(Best & best) {
    sg.unlock();
 }
 
+int hit_rate(int64 hits, int64 probes) { // permille
+   return (probes == 0) ? 0 : int(hits * 1000 / probes);
+}
+
+void write_cache_info() {
+
+   int64 pawn_probes = 0;
+   int64 pawn_hits = 0;
+   int64 eval_probes = 0;
+   int64 eval_hits = 0;
+
+   for (int id = 0; id < engine::engine.threads; id++) {
+      const Search_Local & sl = *p_sl[id];
+      pawn_probes += sl.pawn_table.probes();
+      pawn_hits   += sl.pawn_table.hits();
+      eval_probes += sl.eval_table.probes();
+      eval_hits   += sl.eval_table.hits();
+   }
+
+   int pawn_rate = hit_rate(pawn_hits, pawn_probes);
+   int eval_rate = hit_rate(eval_hits, eval_probes);
+
+   std::cout << "info string pawn cache hits " << pawn_rate / 10 << "." << pawn_rate % 10 << "%";
+   std::cout << " eval cache hits " << eval_rate / 10 << "." << eval_rate % 10 << "%";
+   std::cout << std::endl;
+}
+
 void write_info() {
 
    sg.lock();
@@ -5889,6 +6371,8 @@ void write_info() {
    std::cout << " hashfull " << sg.trans.used();
    std::cout << std::endl;
 
+   write_cache_info();
+
    sg.unlock();
 }
 
@@ -5935,10 +6419,13 @@ void update_best(Best & best, int sc, int flags, const PV & pv) {
    assert(sc != score::NONE);
    assert(pv.size() != 0);
 
-   p_time.drop = flags == score::FLAGS_UPPER || (sc <= p_time.last_score - 30 && current.size > 1);
+   if (&best == &line[0]) { // time management follows the first line only
 
-   if (pv.move(0) != best.move || p_time.drop) {
-      p_time.flag = false;
+      p_time.drop = flags == score::FLAGS_UPPER || (sc <= p_time.last_score - 30 && current.size > 1);
+
+      if (pv.move(0) != best.move || p_time.drop) {
+         p_time.flag = false;
+      }
    }
 
    best.depth = current.depth;
@@ -5948,10 +6435,42 @@ void update_best(Best & best, int sc, int flags, const PV & pv) {
    best.pv = pv;
 }
 
+void write_stats() {
+
+   Stats total;
+   std::memset(&total, 0, sizeof(Stats));
+
+   int64 pawn_probes = 0;
+   int64 eval_probes = 0;
+   int64 eval_hits = 0;
+
+   for (int id = 0; id < engine::engine.threads; id++) {
+
+      const Search_Local & sl = *p_sl[id];
+
+      total.gen         += sl.stats.gen;
+      total.eval        += sl.stats.eval;
+      total.trans_probe += sl.stats.trans_probe;
+      total.trans_hit   += sl.stats.trans_hit;
+      total.split       += sl.stats.split;
+      total.split_work  += sl.stats.split_work;
+      total.split_time  += sl.stats.split_time;
+
+      pawn_probes += sl.pawn_table.probes() - sl.pawn_table.hits();
+      eval_probes += sl.eval_table.probes();
+      eval_hits   += sl.eval_table.hits();
+   }
+
+   std::cout << "info string stats nodes " << current.node << " gen " << total.gen << " eval " << total.eval << " comp_eval " << eval_probes - eval_hits << " comp_info " << pawn_probes << std::endl;
+   std::cout << "info string stats trans probes " << total.trans_probe << " hits " << total.trans_hit << " splits " << total.split << " helpers " << total.split_work << " split time " << total.split_time / 1000 << " ms" << std::endl;
+   std::cout << "info string stats hash " << sg.trans.size() << " MB huge pages " << (sg.trans.huge() ? "on" : "off") << std::endl;
+}
+
 void search_end() {
    p_time.timer.stop();
    update_current();
    write_info();
+   if (engine::engine.stats) write_stats();
 }
 
 void idle_loop(Search_Local & sl, Split_Point & wait_sp) {
@@ -6005,14 +6524,47 @@ void helper_program(Search_Local * sl) {
    idle_loop(*sl, root_sp);
 }
 
+// Lazy SMP: helpers run their own iterative deepening from the root and only share the transposition table.
+// Helper depths are staggered by skipping iterations, so that they tend to search ahead of the master.
+
+const int SKIP_SIZE  [20] = { 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4 };
+const int SKIP_PHASE [20] = { 0, 1, 0, 1, 2, 3, 0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 6, 7 };
+
+void lazy_program(Search_Local * sl) {
+
+   assert(sl->id != 0);
+
+   sl_init_late(*sl);
+   sl_push(*sl, root_sp); // aborted together with the master
+
+   int i = (sl->id - 1) % 20;
+
+   try {
+
+      for (int depth = 1; depth <= p_time.depth_limit; depth++) {
+
+         if ((depth + SKIP_PHASE[i]) / SKIP_SIZE[i] % 2 != 0) continue;
+
+         PV pv;
+         search(*sl, depth, score::MIN, score::MAX, pv);
+      }
+
+   } catch (const Abort & /* abort */) {
+      // no-op
+   }
+
+   sl_pop(*sl);
+}
+
 bool can_split(Search_Local & master, Split_Point & parent) {
 
    if (engine::engine.threads == 1) return false;
+   if (engine::engine.lazy_smp) return false;
    if (master.msp_stack_size >= 16) return false;
    if (sl_stop(master)) return false;
 
    for (int id = 0; id < engine::engine.threads; id++) {
-      Search_Local & worker = p_sl[id];
+      Search_Local & worker = *p_sl[id];
       if (&worker != &master && sl_idle(worker, &parent)) return true;
    }
 
@@ -6039,10 +6591,11 @@ void init_sg() {
    sg.history.clear();
 }
 
-void search_root(Search_Local & sl, gen::List & ml, int depth, int alpha, int beta) {
+void search_root(Search_Local & sl, gen::List & ml, int first, int depth, int alpha, int beta) { // moves before first belong to earlier MultiPV lines
 
    assert(depth > 0 && depth < MAX_DEPTH);
    assert(alpha < beta);
+   assert(first >= 0 && first < ml.size());
 
    board::Board & bd = sl.board;
    assert(attack::is_legal(bd));
@@ -6057,7 +6610,9 @@ void search_root(Search_Local & sl, gen::List & ml, int depth, int alpha, int be
 
    hash_t key = 0;
 
-   if (depth >= 0) {
+   bool use_trans = depth >= 0 && first == 0; // a partial move list does not give the root score
+
+   if (use_trans) {
       key = bd.key();
    }
 
@@ -6067,7 +6622,7 @@ void search_root(Search_Local & sl, gen::List & ml, int depth, int alpha, int be
 
    int searched_size = 0;
 
-   for (int pos = 0; pos < ml.size(); pos++) {
+   for (int pos = first; pos < ml.size(); pos++) {
 
       int mv = ml.move(pos);
 
@@ -6113,10 +6668,12 @@ void search_root(Search_Local & sl, gen::List & ml, int depth, int alpha, int be
          PV pv;
          pv.cat(mv, npv);
 
-         update_best(best, sc, score::flags(sc, alpha, beta), pv);
+         update_best(line[first], sc, score::flags(sc, alpha, beta), pv);
 
-         update_current();
-         write_pv(best);
+         if (engine::engine.multi_pv == 1) {
+            update_current();
+            write_pv(best, 0);
+         }
 
          if (sc > alpha) {
 
@@ -6124,9 +6681,9 @@ void search_root(Search_Local & sl, gen::List & ml, int depth, int alpha, int be
             alpha = sc;
 
             // ml.set_score(pos, sc); // not needed
-            ml.move_to_front(pos);
+            ml.move_to_front(pos, first);
 
-            if (depth >= 0) {
+            if (use_trans) {
                sg.trans.store(key, depth, bd.ply(), mv, sc, score::FLAGS_LOWER);
             }
 
@@ -6138,7 +6695,7 @@ void search_root(Search_Local & sl, gen::List & ml, int depth, int alpha, int be
    assert(bs != score::NONE);
    assert(bs < beta);
 
-   if (depth >= 0) {
+   if (use_trans) {
       int flags = score::flags(bs, old_alpha, beta);
       sg.trans.store(key, depth, bd.ply(), bm, bs, flags);
    }
@@ -6197,7 +6754,12 @@ int search(Search_Local & sl, int depth, int alpha, int beta, PV & pv) {
       int score;
       int flags;
 
-      if (sg.trans.retrieve(key, trans_depth, bd.ply(), trans_move, score, flags) && !pv_node) { // assigns trans_move #
+      bool trans_hit = sg.trans.retrieve(key, trans_depth, bd.ply(), trans_move, score, flags); // assigns trans_move #
+
+      sl.stats.trans_probe++;
+      if (trans_hit) sl.stats.trans_hit++;
+
+      if (trans_hit && !pv_node) {
          if (flags == score::FLAGS_LOWER && score >= beta)  return score;
          if (flags == score::FLAGS_UPPER && score <= alpha) return score;
          if (flags == score::FLAGS_EXACT) return score;
@@ -6303,6 +6865,7 @@ int search(Search_Local & sl, int depth, int alpha, int beta, PV & pv) {
 
    gen_sort::List ml;
    ml.init(depth, bd, attacks, trans_move, sl.killer, sg.history, use_fp);
+   sl.stats.gen++;
 
    gen::List searched;
 
@@ -6398,8 +6961,12 @@ int search(Search_Local & sl, int depth, int alpha, int beta, PV & pv) {
 
 int split(Search_Local & master, int depth, int old_alpha, int alpha, int beta, PV & pv, gen_sort::List & todo, const gen::List & done, int bs, int bm) {
 
+   int64 start = engine::engine.stats ? util::micro_time() : 0;
+
    smp.lock();
 
+   master.stats.split++;
+
    assert(master.msp_stack_size < 16);
    Split_Point & sp = master.msp_stack[master.msp_stack_size++];
 
@@ -6409,15 +6976,18 @@ int split(Search_Local & master, int depth, int old_alpha, int alpha, int beta,
 
    for (int id = 0; id < engine::engine.threads; id++) {
 
-      Search_Local & worker = p_sl[id];
+      Search_Local & worker = *p_sl[id];
 
       if (&worker != &master && sl_idle(worker, &parent)) {
          send_work(worker, sp);
+         master.stats.split_work++;
       }
    }
 
    smp.unlock();
 
+   if (engine::engine.stats) master.stats.split_time += util::micro_time() - start;
+
    try {
       master_split_point(master, sp);
    } catch (const Abort & /* abort */) {
@@ -6447,9 +7017,13 @@ void master_split_point(Search_Local & sl, Split_Point & sp) {
 
    sp.leave();
 
+   int64 start = engine::engine.stats ? util::micro_time() : 0;
+
    idle_loop(sl, sp);
    sl.board = sp.board();
 
+   if (engine::engine.stats) sl.stats.split_time += util::micro_time() - start;
+
    assert(sp.free());
 
    // update move-ordering tables
@@ -6692,6 +7266,7 @@ void undo(Search_Local & sl) {
 }
 
 int eval(Search_Local & sl) {
+   sl.stats.eval++;
    board::Board & bd = sl.board;
    return eval::eval(bd, sl.eval_table, sl.pawn_table);
 }
@@ -6759,12 +7334,30 @@ void sl_init_early(Search_Local & sl, int id) {
 
    sl.msp_stack_size = 0;
    sl.ssp_stack_size = 0;
+
+   sl.stats.gen = 0;
+   sl.stats.eval = 0;
+   sl.stats.trans_probe = 0;
+   sl.stats.trans_hit = 0;
+   sl.stats.split = 0;
+   sl.stats.split_work = 0;
+   sl.stats.split_time = 0;
 }
 
 void sl_init_late(Search_Local & sl) {
+
    sl.killer.clear();
-   sl.pawn_table.clear(); // pawn-eval cache
-   sl.eval_table.clear(); // eval cache
+
+   if (engine::engine.shared_cache) {
+      sl.pawn_table.share(sg.pawn_table); // pawn-eval cache
+      sl.eval_table.share(sg.eval_table); // eval cache
+   } else {
+      sl.pawn_table.set_size(engine::engine.pawn_hash); // allocated by the owning thread
+      sl.eval_table.set_size(engine::engine.eval_hash);
+   }
+
+   sl.pawn_table.clear_stats();
+   sl.eval_table.clear_stats();
 }
 
 void sl_set_root(Search_Local & sl, const board::Board & bd) {
@@ -6823,40 +7416,68 @@ void sg_abort() {
    root_sp.update_root();
 
    for (int id = 0; id < engine::engine.threads; id++) {
-      sl_signal(p_sl[id]);
+      sl_signal(*p_sl[id]);
    }
 }
 
-void search_asp(gen::List & ml, int depth) {
+void search_asp(gen::List & ml, int first, int depth) { // aspiration window around the line's previous score
+
+   Search_Local & sl = *p_sl[0];
 
-   Search_Local & sl = p_sl[0];
+   Best & bst = line[first];
+   int last_score = bst.score;
 
-   assert(depth <= 1 || p_time.last_score == best.score);
+   assert(depth <= 1 || first != 0 || p_time.last_score == best.score);
 
-   if (depth >= 6 && !score::is_mate(p_time.last_score)) {
+   if (depth >= 6 && !score::is_mate(last_score)) {
 
       for (int margin = 10; margin < 500; margin *= 2) {
 
-         int a = p_time.last_score - margin;
-         int b = p_time.last_score + margin;
+         int a = last_score - margin;
+         int b = last_score + margin;
          assert(score::EVAL_MIN <= a && a < b && b <= score::EVAL_MAX);
 
-         search_root(sl, ml, depth, a, b);
+         search_root(sl, ml, first, depth, a, b);
 
-         if (best.score > a && best.score < b) {
+         if (bst.score > a && bst.score < b) {
             return;
-         } else if (score::is_mate(best.score)) {
+         } else if (score::is_mate(bst.score)) {
             break;
          }
       }
    }
 
-   search_root(sl, ml, depth, score::MIN, score::MAX);
+   search_root(sl, ml, first, depth, score::MIN, score::MAX);
+}
+
+void sort_lines(gen::List & ml, int size) { // insert the last searched line, keeping ml in line order
+
+   assert(size > 0);
+
+   for (int i = size - 1; i > 0 && line[i - 1].score < line[i].score; i--) {
+
+      assert(ml.move(i) == line[i].move);
+
+      Best tmp = line[i];
+      line[i] = line[i - 1];
+      line[i - 1] = tmp;
+
+      ml.move_to_front(i, i - 1);
+   }
+}
+
+void write_lines(int size) {
+
+   update_current();
+
+   for (int i = 0; i < size; i++) {
+      write_pv(line[i], i);
+   }
 }
 
 void search_id(const board::Board & bd) {
 
-   Search_Local & sl = p_sl[0];
+   Search_Local & sl = *p_sl[0];
 
    sl_set_root(sl, bd);
 
@@ -6868,8 +7489,27 @@ void search_id(const board::Board & bd) {
    gen_sort(sl, ml);
    assert(ml.size() != 0);
 
-   best.move = ml.move(0);
-   best.score = 0;
+   if (p_time.search_moves.size() != 0) { // "go searchmoves"
+
+      gen::List tmp;
+
+      for (int pos = 0; pos < ml.size(); pos++) {
+         int mv = ml.move(pos);
+         if (p_time.search_moves.contain(mv)) tmp.add(mv, ml.score(pos));
+      }
+
+      if (tmp.size() != 0) ml = tmp; // ignore illegal lists
+   }
+
+   int lines = std::min(engine::engine.multi_pv, ml.size());
+
+   for (int i = 0; i < lines; i++) {
+      line[i].depth = 0;
+      line[i].move = ml.move(i);
+      line[i].score = 0;
+      line[i].flags = score::FLAGS_NONE;
+      line[i].pv.clear();
+   }
 
    bool easy = (ml.size() == 1 || (ml.size() > 1 && ml.score(0) - ml.score(1) >= 50 / 4)); // HACK: uses gen_sort() internals
    int easy_move = ml.move(0);
@@ -6883,7 +7523,17 @@ void search_id(const board::Board & bd) {
    for (int depth = 1; depth <= p_time.depth_limit; depth++) {
 
       depth_start(depth);
-      search_asp(ml, depth);
+
+      for (int i = 0; i < lines; i++) {
+
+         search_asp(ml, i, depth);
+
+         if (lines > 1) {
+            sort_lines(ml, i + 1);
+            write_lines(i + 1);
+         }
+      }
+
       depth_end();
 
       // p_time.drop = (best.score <= p_time.last_score - 50); // moved to update_best()
@@ -6926,22 +7576,41 @@ void search_id(const board::Board & bd) {
 
 void search_go(const board::Board & bd) {
 
-   clear();
+   clear(); // starts the timer
+
+   if (sg.trans.dirty()) { // GUI skipped isready after ucinewgame or resize; charged to the search
+      sg.trans.clear(engine::engine.threads);
+   }
 
    init_sg();
    sg.trans.inc_date();
 
+   if (engine::engine.shared_cache) { // NOTE: entries are kept across searches
+      sg.pawn_table.set_size(engine::engine.pawn_hash);
+      sg.eval_table.set_size(engine::engine.eval_hash);
+   } else {
+      sg.pawn_table.free();
+      sg.eval_table.free();
+   }
+
+   sl_alloc(engine::engine.threads);
+
    for (int id = 0; id < engine::engine.threads; id++) {
-      sl_init_early(p_sl[id], id);
+      sl_init_early(*p_sl[id], id);
    }
 
-   root_sp.init_root(p_sl[0]);
+   root_sp.init_root(*p_sl[0]);
 
    for (int id = 1; id < engine::engine.threads; id++) { // skip 0
-      p_sl[id].thread = std::thread(helper_program, &p_sl[id]);
+      if (engine::engine.lazy_smp) {
+         sl_set_root(*p_sl[id], bd);
+         p_sl[id]->thread = std::thread(lazy_program, p_sl[id]);
+      } else {
+         p_sl[id]->thread = std::thread(helper_program, p_sl[id]);
+      }
    }
 
-   sl_init_late(p_sl[0]);
+   sl_init_late(*p_sl[0]);
 
    try {
       search_id(bd);
@@ -6952,7 +7621,7 @@ void search_go(const board::Board & bd) {
    sg_abort();
 
    for (int id = 1; id < engine::engine.threads; id++) { // skip 0
-      p_sl[id].thread.join();
+      p_sl[id]->thread.join();
    }
 
    search_end();
@@ -7002,6 +7671,155 @@ void init() {
 
 }
 
+namespace bench {
+
+const std::string fens[] = {
+   board::start_fen,
+   "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 10",
+   "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 11",
+   "4rrk1/pp1n3p/3q2pQ/2p1pb2/2PP4/2P3N1/P2B2PP/4RRK1 b - - 7 19",
+   "rq3rk1/ppp2ppp/1bnpb3/3N2B1/3NP3/7P/PPPQ1PP1/2KR3R w - - 7 14",
+   "r1bq1r1k/1pp1n1pp/1p1p4/4p2Q/4Pp2/1BNP4/PPP2PPP/3R1RK1 w - - 2 14",
+   "r3r1k1/2p2ppp/p1p1bn2/8/1q2P3/2NPQN2/PPP3PP/R4RK1 b - - 2 15",
+   "r1bbk1nr/pp3p1p/2n5/1N4p1/2Np1B2/8/PPP2PPP/2KR1B1R w kq - 0 13",
+   "r1bq1rk1/ppp1nppp/4n3/3p3Q/3P4/1BP1B3/PP1N2PP/R4RK1 w - - 1 16",
+   "4r1k1/r1q2ppp/ppp2n2/4P3/5Rb1/1N1BQ3/PPP3PP/R5K1 w - - 1 17",
+   "6k1/6p1/6Pp/ppp5/3pn2P/1P3K2/1PP2P2/3N4 b - - 0 1",
+   "8/8/8/8/5kp1/P7/8/1K1N4 w - - 0 1",
+};
+
+void bench(int depth, int threads) { // fixed positions and depth: with one thread the node count is a signature of the search
+
+   engine::Engine saved = engine::engine;
+
+   engine::engine.threads = std::max(1, std::min(threads, search::MAX_THREADS));
+   engine::engine.multi_pv = 1;
+
+   int64 node = 0;
+   int64 time = 0;
+
+   for (int i = 0; i < int(sizeof(fens) / sizeof(fens[0])); i++) {
+
+      board::Board bd;
+      bd.init_fen(fens[i]);
+
+      search::sg.trans.clear(engine::engine.threads); // outside the timed search
+
+      search::new_search();
+      search::set_depth_limit(depth);
+      search::search_dumb(bd);
+
+      node += search::current.node;
+      time += search::current.time;
+   }
+
+   engine::engine = saved;
+
+   std::cout << "info string bench depth " << depth << " threads " << threads;
+   std::cout << " nodes " << node << " time " << time;
+   std::cout << " nps " << ((time == 0) ? 0 : node * 1000 / time) << std::endl;
+}
+
+int64 perft(board::Board & bd, int depth) {
+
+   assert(depth > 0);
+
+   int sd = bd.turn();
+
+   attack::Attacks attacks;
+   attack::init_attacks(attacks, bd);
+
+   gen::List ml;
+
+   if (attacks.size != 0) {
+      gen::add_evasions(ml, sd, bd, attacks);
+   } else {
+      gen::add_captures(ml, sd, bd);
+      gen::add_promotions(ml, sd, bd);
+      gen::add_quiets(ml, sd, bd);
+   }
+
+   int64 node = 0;
+
+   for (int pos = 0; pos < ml.size(); pos++) {
+
+      int mv = ml.move(pos);
+      if (!move::is_legal(mv, bd, attacks)) continue;
+
+      if (depth == 1) { // bulk counting
+         node++;
+      } else {
+         bd.move(mv);
+         node += perft(bd, depth - 1);
+         bd.undo();
+      }
+   }
+
+   return node;
+}
+
+void perft_program(const board::Board * root, const gen::List * ml, int id, int threads, int depth, std::vector<int64> * count) { // root moves id, id + threads, ...
+
+   board::Board bd;
+   bd = *root;
+
+   for (int pos = id; pos < ml->size(); pos += threads) {
+
+      if (depth == 1) {
+         (*count)[pos] = 1;
+      } else {
+         bd.move(ml->move(pos));
+         (*count)[pos] = perft(bd, depth - 1);
+         bd.undo();
+      }
+   }
+}
+
+void perft_divide(const board::Board & root, int depth, int threads) {
+
+   board::Board bd;
+   bd = root;
+
+   gen::List ml;
+   gen::gen_legals(ml, bd);
+
+   depth = std::max(depth, 1);
+   threads = std::max(1, std::min(threads, search::MAX_THREADS));
+
+   std::vector<int64> count(ml.size(), 0);
+   std::vector<std::thread> thread;
+
+   util::Timer timer;
+   timer.start();
+
+   for (int id = 1; id < threads; id++) { // skip 0
+      thread.push_back(std::thread(perft_program, &bd, &ml, id, threads, depth, &count));
+   }
+
+   perft_program(&bd, &ml, 0, threads, depth, &count);
+
+   for (int i = 0; i < int(thread.size()); i++) {
+      thread[i].join();
+   }
+
+   timer.stop();
+
+   int64 node = 0;
+
+   for (int pos = 0; pos < ml.size(); pos++) {
+      std::cout << move::to_can(ml.move(pos)) << " " << count[pos] << std::endl;
+      node += count[pos];
+   }
+
+   int64 time = timer.elapsed();
+
+   std::cout << "perft depth " << depth << " threads " << threads;
+   std::cout << " nodes " << node << " time " << time;
+   std::cout << " nps " << ((time == 0) ? 0 : node * 1000 / time) << std::endl;
+}
+
+}
+
 namespace uci {
 
 board::Board bd;
@@ -7114,15 +7932,25 @@ void command(Scanner & scan) {
       std::cout << "id name Senpai 1.0" << std::endl;
       std::cout << "id author Fabien Letouzey" << std::endl;
 
-      std::cout << "option name Hash type spin default " << engine::engine.hash << " min 16 max 16384" << std::endl;
+      std::cout << "option name Hash type spin default " << engine::engine.hash << " min 16 max " << trans::MAX_HASH << std::endl;
       std::cout << "option name Ponder type check default " << engine::engine.ponder << std::endl;
-      std::cout << "option name Threads type spin default " << engine::engine.threads << " min 1 max 16" << std::endl;
+      std::cout << "option name Threads type spin default " << engine::engine.threads << " min 1 max " << search::MAX_THREADS << std::endl;
+      std::cout << "option name SMP type combo default " << (engine::engine.lazy_smp ? "Lazy" : "Split") << " var Split var Lazy" << std::endl;
+      std::cout << "option name Pawn Hash type spin default " << engine::engine.pawn_hash << " min 1 max 1024" << std::endl;
+      std::cout << "option name Eval Hash type spin default " << engine::engine.eval_hash << " min 1 max 1024" << std::endl;
+      std::cout << "option name Shared Eval Cache type check default " << engine::engine.shared_cache << std::endl;
+      std::cout << "option name MultiPV type spin default " << engine::engine.multi_pv << " min 1 max " << search::MAX_MULTI_PV << std::endl;
+      std::cout << "option name Stats type check default " << engine::engine.stats << std::endl;
       std::cout << "option name Log File type check default " << engine::engine.log << std::endl;
 
       std::cout << "uciok" << std::endl;
 
    } else if (command == "isready") {
 
+      if (search::sg.trans.dirty()) { // deferred clear after ucinewgame or resize
+         search::sg.trans.clear(engine::engine.threads);
+      }
+
       std::cout << "readyok" << std::endl;
 
    } else if (command == "setoption") {
@@ -7147,19 +7975,31 @@ void command(Scanner & scan) {
 
       if (false) {
       } else if (util::string_case_equal(name, "Hash")) {
-         engine::engine.hash = int(util::to_int(value));
+         engine::engine.hash = std::max(16, std::min(int(util::to_int(value)), trans::MAX_HASH));
          search::sg.trans.set_size(engine::engine.hash);
       } else if (util::string_case_equal(name, "Ponder")) {
          engine::engine.ponder = util::to_bool(value);
       } else if (util::string_case_equal(name, "Threads") || util::string_case_equal(name, "Cores")) {
-         engine::engine.threads = int(util::to_int(value));
+         engine::engine.threads = std::max(1, std::min(int(util::to_int(value)), search::MAX_THREADS));
+      } else if (util::string_case_equal(name, "SMP")) {
+         engine::engine.lazy_smp = util::string_case_equal(value, "Lazy");
+      } else if (util::string_case_equal(name, "Pawn Hash")) {
+         engine::engine.pawn_hash = std::max(1, std::min(int(util::to_int(value)), 1024)); // resized at next search
+      } else if (util::string_case_equal(name, "Eval Hash")) {
+         engine::engine.eval_hash = std::max(1, std::min(int(util::to_int(value)), 1024));
+      } else if (util::string_case_equal(name, "Shared Eval Cache")) {
+         engine::engine.shared_cache = util::to_bool(value);
+      } else if (util::string_case_equal(name, "MultiPV")) {
+         engine::engine.multi_pv = std::max(1, std::min(int(util::to_int(value)), search::MAX_MULTI_PV));
+      } else if (util::string_case_equal(name, "Stats")) {
+         engine::engine.stats = util::to_bool(value);
       } else if (util::string_case_equal(name, "Log File")) {
          engine::engine.log = util::to_bool(value);
       }
 
    } else if (command == "ucinewgame") {
 
-      search::sg.trans.clear();
+      search::sg.trans.clear_later();
 
    } else if (command == "position") {
 
@@ -7224,6 +8064,15 @@ void command(Scanner & scan) {
 
          if (false) {
 
+         } else if (part == "searchmoves") {
+
+            std::stringstream ss(args);
+            std::string word;
+
+            while (ss >> word) {
+               if (word.length() >= 4) search::add_search_move(move::from_string(word, bd));
+            }
+
          } else if (part == "ponder") {
 
             infinite = true;
@@ -7292,6 +8141,19 @@ void command(Scanner & scan) {
          send_bestmove();
       }
 
+   } else if (command == "bench") { // bench [depth [threads]]
+
+      std::string depth = scan.get_word();
+      std::string threads = scan.get_word();
+
+      bench::bench(depth != "" ? int(util::to_int(depth)) : 12, threads != "" ? int(util::to_int(threads)) : 1);
+
+   } else if (command == "perft") { // perft depth, uses "Threads"
+
+      std::string depth = scan.get_word();
+
+      bench::perft_divide(bd, depth != "" ? int(util::to_int(depth)) : 1, engine::engine.threads);
+
    } else if (command == "stop") {
 
       if (delay) send_bestmove();
@@ -7340,7 +8202,6 @@ int main(int argc, char* argv[]) {
    assert(sizeof(uint32) == 4);
    assert(sizeof(uint64) == 8);
 
-   input::init();
    bit::init();
    hash::init();
    castling::init();
@@ -7352,6 +8213,14 @@ int main(int argc, char* argv[]) {
    eval::init();
    search::init();
 
+   if (argc > 1 && std::string(argv[1]) == "bench") { // senpai bench [depth [threads]]
+      int depth = (argc > 2) ? int(util::to_int(argv[2])) : 12;
+      int threads = (argc > 3) ? int(util::to_int(argv[3])) : 1;
+      bench::bench(depth, threads);
+      return EXIT_SUCCESS;
+   }
+
+   input::init();
    uci::loop();
 
    return EXIT_SUCCESS;